@@ -0,0 +1,88 @@
+#include "recursive_filter.h"
+#include <tbb/tbb.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+// AVX2
+using V = Vec8f;
+
+// V: data type of SIMD vector. T: data type of values in SIMD vector
+using T = decltype(std::declval<V>().extract(0));
+
+// M: length of SIMD vector.
+constexpr static int M = V::size();
+constexpr static int L = M*M;
+
+// time a cascade of option 3 over the input and return the max error to the reference
+template<typename S> double run(const char* name, S& series, const std::vector<T>& in, const std::vector<double>& ref){
+
+    std::vector<T> out(in.size());
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t n = 0; n < in.size(); n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&in[n + j*M]);
+
+        auto y = _permuteV(series.series_option3(_permuteV(x)));
+        for (auto j = 0; j < M; j++) y[j].store(&out[n + j*M]);
+    }
+
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    double err = 0;
+    for (size_t n = 0; n < in.size(); n++) err = std::max(err, std::abs(out[n] - ref[n]));
+
+    std::cout << name << ": " << std::chrono::duration_cast<std::chrono::nanoseconds>(finish-start).count() << "ns, max error " << err << "\n";
+
+    return err;
+}
+
+int main(){
+
+    // filter parameters: order 12 as 6 second order sections
+    constexpr int N = 6;
+    T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3
+                    ,1,0.4,0.2,-0.6,-0.2
+                    ,1,-0.3,0.1,0.9,-0.5
+                    ,1,0.2,0.3,-0.1,0.4
+                    ,1,0.5,-0.1,0.2,-0.7
+                    ,1,-0.2,-0.4,1.2,-0.45
+                    };
+
+    // 1.024M samples
+    static const int vector_size = 1024000;
+    std::vector<T> in(vector_size);
+    for (size_t n = 0; n < in.size(); n++) in[n] = std::sin(0.01*n) + 0.1*(n%13);
+
+    // the cascade in double precision as reference
+    std::vector<double> ref(in.begin(), in.end());
+    for (int i = 0; i < N; i++){
+
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (auto& v: ref){
+            double r = v + coefs[i][1]*x1 + coefs[i][2]*x2 + coefs[i][3]*y1 + coefs[i][4]*y2;
+            x2 = x1; x1 = v; y2 = y1; y1 = r;
+            v = r;
+        }
+    }
+
+    auto m4 = merge_sections<4>(&coefs[0][0], N);
+    auto m6 = merge_sections<6>(&coefs[0][0], N);
+    const T zeros[12] = {0};
+
+    auto S2 = make_series(IirCoreOrderTwo<V>(coefs[0], zeros), IirCoreOrderTwo<V>(coefs[1], zeros), IirCoreOrderTwo<V>(coefs[2], zeros),
+                          IirCoreOrderTwo<V>(coefs[3], zeros), IirCoreOrderTwo<V>(coefs[4], zeros), IirCoreOrderTwo<V>(coefs[5], zeros));
+    auto S4 = make_series(IirCoreOrderFour<V>(&m4[0], zeros), IirCoreOrderFour<V>(&m4[9], zeros), IirCoreOrderFour<V>(&m4[18], zeros));
+    auto S6 = make_series(IirCoreOrderSix<V>(&m6[0], zeros), IirCoreOrderSix<V>(&m6[13], zeros));
+
+    run("6 second order sections", S2, in, ref);
+    run("3 fourth order sections", S4, in, ref);
+    run("2 sixth order sections", S6, in, ref);
+
+    return 0;
+
+}
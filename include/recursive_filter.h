@@ -1,12 +1,22 @@
 // basic function
 #include "recursive_filter/shift_reg.h"
+#include "recursive_filter/simd_vec.h"
 #include "recursive_filter/permuteV.h"
+#include "recursive_filter/section_table.h"
+#include "recursive_filter/first_order_table.h"
+#include "recursive_filter/steady_state.h"
+#include "recursive_filter/zero_gap.h"
+#include "recursive_filter/fir_history.h"
 
 // single-core single block processing
 #include "recursive_filter/zero_init_condition_serial.h"
 #include "recursive_filter/init_cond_correction_serial.h"
 #include "recursive_filter/second_order_cores_serial.h"
+#include "recursive_filter/first_order_cores_serial.h"
+#include "recursive_filter/higher_order_cores_serial.h"
+#include "recursive_filter/allpass_cores_serial.h"
 #include "recursive_filter/series_serial.h"
+#include "recursive_filter/runtime_series.h"
 
 // multi-core inter block processing
 #include "recursive_filter/data_block.h"
@@ -16,6 +26,29 @@
 #include "recursive_filter/buffer.h"
 #include "recursive_filter/inter_block_rd.h"
 #include "recursive_filter/icc_forward.h"
+#include "recursive_filter/first_order_nodes.h"
+#include "recursive_filter/allpass_nodes.h"
+#include "recursive_filter/higher_order_nodes.h"
 #include "recursive_filter/tbb_iir_multi_core.h"
 #include "recursive_filter/multi_core_filter.h"
+#include "recursive_filter/seekable_filter.h"
+#include "recursive_filter/filter_bank.h"
+#include "recursive_filter/parallel_filter.h"
+#include "recursive_filter/state_space_filter.h"
+#include "recursive_filter/split_filter.h"
+#include "recursive_filter/halfband_filter.h"
+#include "recursive_filter/warmup_filter.h"
+
+// time-varying coefficients
+#include "recursive_filter/coef_control.h"
+#include "recursive_filter/tbb_iir_varying.h"
+#include "recursive_filter/varying_filter.h"
+
+// many channels
+#include "recursive_filter/multi_channel_filter.h"
+#include "recursive_filter/batch_filter.h"
+#include "recursive_filter/stream_scheduler.h"
+
+// linear recurrences with coefficients per sample
+#include "recursive_filter/linear_scan.h"
 
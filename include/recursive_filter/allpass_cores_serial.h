@@ -0,0 +1,268 @@
+#ifndef ALLPASS_CORES_H
+#define ALLPASS_CORES_H 1
+
+#include <array>
+#include <memory>
+#include <cassert>
+#include "vectorclass.h"
+#include "shift_reg.h"
+#include "permuteV.h"
+#include "section_table.h"
+#include "init_cond_correction_serial.h"
+
+/*
+    Immutable pre-computed table of an allpass section, whose numerator is the reversed denominator 1 - a1 z^{-1} - a2 z^{-2}:
+
+        second order: y_n = -a2 x_n - a1 x_{n-1} + x_{n-2} + a1 y_{n-1} + a2 y_{n-2},
+        first order (a2 = 0): y_n = -a1 x_n + x_{n-1} + a1 y_{n-1}.
+
+    The homogeneous part is the one of any section with the same poles, so the table is the SectionTable of the numerator
+    without b0, [1 b1 b2], which gives the responses p1, p2 to x_{-1}, x_{-2} as well, plus the toeplitz matrix G of the allpass
+    impulse response that replaces H for b0 = -a2 (or -a1) in block filtering.
+ */
+template<typename V> struct alignas(64) AllpassTable: public SectionTable<V>{
+
+    using T = typename SectionTable<V>::T;
+    using SectionTable<V>::M;
+
+    // 1 or 2
+    int order;
+
+    // the coefficient of x_n
+    T b0;
+
+    // M by M lower triangular toeplitz matrix of the allpass section for block filtering.
+    std::array<V,M> G;
+
+    AllpassTable(const T a1_, const T a2_): SectionTable<V>((a2_ == 0) ? T(1) : -a1_, (a2_ == 0) ? T(0) : T(1), a1_, a2_),
+                                            order((a2_ == 0) ? 1 : 2), b0((a2_ == 0) ? -a1_ : -a2_) {
+
+        assert(b0 != 0);
+
+        // the impulse response of the allpass section, and the rest columns are shifted by 1 position in G
+        T g[2*M] = {0}, y1 = 0, y2 = 0;
+        for (auto n=0; n<M; n++){
+
+            T x = (n == 0) ? b0 : (n == 1) ? this->b1 : (n == 2) ? this->b2 : T(0);
+            g[M+n] = x + this->a1*y1 + this->a2*y2;
+            y2 = y1;
+            y1 = g[M+n];
+        }
+
+        for (auto n=0; n<M; n++) G[n].load(&g[M-n]);
+    };
+
+};
+
+template<typename V, typename T> inline std::shared_ptr<const AllpassTable<V>> make_allpass_table(const T a1, const T a2) {
+    return std::make_shared<const AllpassTable<V>>(a1, a2);
+};
+
+/*
+    zero initial condition of an allpass section. The numerator [b0 b1 b2] is computed apart from the recursion, which stays
+    w_n = a1 w_{n-1} + a2 w_{n-2} + v_n as in ZeroInitCond, so only 2 dependent FMAs per sample (1 for first order) are on the
+    critical path of a lane, and b0 is applied within the numerator rather than by a gain after the section.
+ */
+template<typename V> class ZeroInitCondAllpass{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const AllpassTable<V>> _tab;
+
+        // shift register storing the pre-conditions of particular part, i.e., x_{-1}, x_{-2}.
+        Shift<V> _S;
+
+    public:
+
+        ZeroInitCondAllpass(){};
+
+        ZeroInitCondAllpass(std::shared_ptr<const AllpassTable<V>> tab, const T xi1=0, const T xi2=0): _tab(std::move(tab)) {
+
+            _S.shift(xi2);
+            _S.shift(xi1);
+        };
+
+        inline void inits_refresh(const T xi2, const T xi1){
+
+            _S.shift(xi2);
+            _S.shift(xi1);
+        }
+
+        inline std::array<T,2> inits() {
+            return {_S[-1], _S[-2]};
+        }
+
+        // calculate the particular part of recursive equation by scalar
+        inline T ZIC_S(const T x) {
+
+            const AllpassTable<V>& t = *_tab;
+            T w = t.b0*x + t.b1*_S[-1] + t.b2*_S[-2];
+
+            _S.shift(x);
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by block filtering
+        inline V ZIC_NT(const V x) {
+
+            const AllpassTable<V>& t = *_tab;
+
+            V w{0};
+            for (auto n=0; n<M; n++) w = mul_add(t.G[n], x[n], w);
+
+            w = mul_add(t.p2, _S[-2], w);
+            w = mul_add(t.p1, _S[-1], w);
+
+            _S.shift(x);
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by multi-block filtering, each lane starts from zero output.
+        inline std::array<V,M> ZIC_T(const std::array<V,M>& x) {
+
+            // the blocks of initial conditions, xi1 = [x_{-1} x_{M-1} x_{2M-1} ...], xi2 = [x_{-2} x_{M-2} x_{2M-2} ...]
+            auto w = kernel(*_tab, x, lane_shift<1>(x[M-1], _S[-1]), lane_shift<1>(x[M-2], _S[-2]));
+
+            _S.shift(x[M-2][M-1]);
+            _S.shift(x[M-1][M-1]);
+
+            return w;
+        };
+
+        // the kernel of multi-block filtering from the blocks of initial conditions xi1, xi2, shared with the multi-core stage.
+        static inline std::array<V,M> kernel(const AllpassTable<V>& t, const std::array<V,M>& x, const V& xi1, const V& xi2) {
+
+            std::array<V,M> v, w;
+
+            if (t.order == 1){
+
+                v[0] = mul_add(x[0], t.b0, xi1);
+                w[0] = v[0];
+
+                for (auto n=1; n<M; n++) {
+
+                    v[n] = mul_add(x[n], t.b0, x[n-1]);
+                    w[n] = mul_add(w[n-1], t.a1, v[n]);
+                }
+
+            } else {
+
+                v[0] = mul_add(x[0], t.b0, mul_add(xi1, t.b1, xi2));
+                w[0] = v[0];
+                v[1] = mul_add(x[1], t.b0, mul_add(x[0], t.b1, xi1));
+                w[1] = mul_add(w[0], t.a1, v[1]);
+
+                for (auto n=2; n<M; n++) {
+
+                    v[n] = mul_add(x[n], t.b0, mul_add(x[n-1], t.b1, x[n-2]));
+                    w[n] = mul_add(w[n-2], t.a2, v[n]);
+                    w[n] = mul_add(w[n-1], t.a1, w[n]);
+                }
+            }
+
+            return w;
+        };
+
+};
+
+/*
+    allpass core composed by the allpass zic and the icc of a second order section, with the same interface as IirCoreOrderTwo
+    so that allpass sections cascade in Series. Initial conditions [xi1 xi2 yi1 yi2].
+ */
+template<typename V> class IirCoreAllpass{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const AllpassTable<V>> _tab;
+
+        ZeroInitCondAllpass<V> _Zic;
+
+        InitCondCorc<V> _Icc;
+
+    public:
+
+        IirCoreAllpass(){};
+
+        // the denominator 1 - a1 z^{-1} - a2 z^{-2}, a first order section if a2 = 0.
+        IirCoreAllpass(const T a1, const T a2, const T xi1=0, const T xi2=0, const T yi1=0, const T yi2=0)
+        : IirCoreAllpass(make_allpass_table<V>(a1, a2), xi1, xi2, yi1, yi2) {};
+
+        IirCoreAllpass(std::shared_ptr<const AllpassTable<V>> tab, const T xi1=0, const T xi2=0, const T yi1=0, const T yi2=0): _tab(std::move(tab)) {
+
+            _Zic = ZeroInitCondAllpass<V>(_tab, xi1, xi2);
+            _Icc = InitCondCorc<V>(_tab, yi1, yi2);
+        };
+
+        // refresh the initial conditions in the order of post_inits, [xi2 xi1 yi2 yi1], as IirCoreOrderTwo does.
+        inline void inits_refresh(const T inits[4]){
+
+            _Zic.inits_refresh(inits[0], inits[1]);
+            _Icc.inits_refresh(inits[2], inits[3]);
+        }
+
+        // the current initial conditions of the section in the order of constructor, [xi1 xi2 yi1 yi2].
+        inline void get_inits(T inits[4]){
+
+            auto x = _Zic.inits();
+            auto y = _Icc.inits();
+
+            inits[0] = x[0];
+            inits[1] = x[1];
+            inits[2] = y[0];
+            inits[3] = y[1];
+        }
+
+        inline const std::shared_ptr<const AllpassTable<V>>& table() const { return _tab; }
+
+        inline T benchmark(const T x) {
+            return _Icc.ICC_S(_Zic.ZIC_S(x));
+        };
+
+        // the option 1, block filtering: ZIC_NT - ICC_NT
+        inline V option1(const V x) {
+            return _Icc.ICC_NT(_Zic.ZIC_NT(x));
+        };
+
+        // the option 2, mixed filtering: T - ZIC_T - T - ICC_NT
+        inline std::array<V,M> option2(const std::array<V,M>& x) {
+            return option2_tail(_permuteV(x));
+        };
+
+        // the option 3, multi-block filtering: T - ZIC_T - ICC_T - T
+        inline std::array<V,M> option3(const std::array<V,M>& x) {
+            return _permuteV(option3_middle(_permuteV(x)));
+        };
+
+        inline std::array<V,M> option2_tail(const std::array<V,M>& x_T) {
+
+            std::array<V,M> w = _permuteV(_Zic.ZIC_T(x_T));
+
+            std::array<V,M> y;
+            for (auto n=0; n<M; n++) y[n] = _Icc.ICC_NT(w[n]);
+
+            return y;
+        };
+
+        inline std::array<V,M> option3_head(const std::array<V,M>& x) {
+            return option3_middle(_permuteV(x));
+        };
+
+        inline std::array<V,M> option3_tail(const std::array<V,M>& x_T) {
+            return _permuteV(option3_middle(x_T));
+        };
+
+        inline std::array<V,M> option3_middle(const std::array<V,M>& x_T) {
+            return _Icc.ICC_T(_Zic.ZIC_T(x_T));
+        };
+
+};
+
+#endif // header guard
@@ -0,0 +1,39 @@
+#ifndef ALLPASS_NODES_H
+#define ALLPASS_NODES_H 1
+
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "data_block.h"
+#include "allpass_cores_serial.h"
+
+// Stateless zero initial condition of an allpass section, the kernel of ZeroInitCondAllpass on the initial conditions of a block.
+template<typename V> class NoStateZICAllpass{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const AllpassTable<V>> _tab;
+
+    public:
+
+        NoStateZICAllpass(std::shared_ptr<const AllpassTable<V>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in) {
+
+            if (in.last){
+
+                in.post_inits.push_back(in.data[M-2][M-1]);
+                in.post_inits.push_back(in.data[M-1][M-1]);
+            };
+
+            in.data = ZeroInitCondAllpass<V>::kernel(*_tab, in.data, lane_shift<1>(in.data[M-1], in.x_inits[1]),
+                                                     lane_shift<1>(in.data[M-2], in.x_inits[0]));
+
+            return in;
+        };
+
+};
+
+#endif // header guard
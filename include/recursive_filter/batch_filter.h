@@ -0,0 +1,106 @@
+#ifndef BATCH_FILTER_H
+#define BATCH_FILTER_H 1
+
+#include <array>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <tbb/tbb.h>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "multi_channel_filter.h"
+#include "simd_vec.h"
+
+// one independent record of a batch: len samples from in to out, inits: [xi1 xi2 yi1 yi2] per section (zeros if null),
+// which are overwritten by the state after the last sample of the record.
+template<typename T> struct Record{
+
+    const T* in;
+    T* out;
+    size_t len;
+    T* inits = nullptr;
+};
+
+/*
+    real function to user: the same cascaded second order filter over many short independent records of different lengths.
+    Each lane of the SIMD vector filters one record and takes the next record of its batch as soon as its record ends, see
+    LaneCascade::run. The records are sorted by length and dealt to the batches in turn, and the batches run on different cores.
+ */
+template<typename T> class BatchFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+
+    using State = typename LaneCascade<V>::State;
+
+    private:
+
+        // the cascade in every lane
+        LaneCascade<V> _sos;
+
+        // number of records a batch is made of per lane
+        size_t _per_lane;
+
+        // filter the records idx[b], idx[b+stride], ... by one vector of lanes.
+        inline void _batch(std::vector<Record<T>>& rec, const std::vector<size_t>& idx, const size_t b, const size_t stride) const {
+
+            std::vector<State> s(_sos.size());
+
+            // the record in each lane (-1: none)
+            std::array<long,M> r;
+            r.fill(-1);
+            size_t next = b;
+
+            // keep the state of the record that ends in lane j and take the next record that is not empty
+            _sos.run(s.data(), [&](int j, const T*& in, T*& out, size_t& len){
+
+                if (r[j] >= 0 && rec[r[j]].inits) _sos.get_lane(s.data(), j, rec[r[j]].inits);
+
+                while (next < idx.size() && rec[idx[next]].len == 0) next += stride;
+
+                if (next >= idx.size()){
+
+                    r[j] = -1;
+                    _sos.set_lane(s.data(), j, nullptr);
+                    return false;
+                }
+
+                r[j] = idx[next];
+                next += stride;
+
+                _sos.set_lane(s.data(), j, rec[r[j]].inits);
+                in = rec[r[j]].in;
+                out = rec[r[j]].out;
+                len = rec[r[j]].len;
+
+                return true;
+            });
+        }
+
+    public:
+
+        // n sections of contiguous coefficients [b0 b1 b2 a1 a2], a batch takes per_lane records per lane on average.
+        BatchFilter(const T* coefs,const int n,const size_t per_lane=4): _sos(coefs,n),_per_lane(per_lane){}
+
+        template<int K> BatchFilter(const T (&coefs)[K][5],const size_t per_lane=4): BatchFilter(&coefs[0][0],K,per_lane){}
+
+        // filter every record from its own initial conditions, the records are independent and may be in any order.
+        inline void operator()(std::vector<Record<T>>& records) const {
+
+            // the longest records first, so the lengths of the records in the lanes of a batch are close
+            std::vector<size_t> idx(records.size());
+            std::iota(idx.begin(), idx.end(), 0);
+            std::stable_sort(idx.begin(), idx.end(), [&](size_t i, size_t j){ return records[i].len > records[j].len; });
+
+            size_t batches = std::max<size_t>(1, (records.size() + M*_per_lane - 1)/(M*_per_lane));
+
+            tbb::parallel_for(size_t(0), batches, [&](size_t b){
+                _batch(records, idx, b, batches);
+            });
+        }
+
+};
+
+#endif // header guard
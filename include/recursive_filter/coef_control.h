@@ -0,0 +1,101 @@
+#ifndef COEF_CONTROL_H
+#define COEF_CONTROL_H 1
+
+#include <array>
+#include <deque>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+// how the coefficients move from one control point to the next.
+enum class Interp { linear, exponential };
+
+/*
+    Coefficients of one second order section that vary from block to block (M*M samples), driven by a stream of control points.
+    linear: the coefficients ramp from the last reached control point to the next one and hold after the last one.
+    exponential: the coefficients move from the last reached control point to the next one over the same blocks as the linear
+    ramp, by the weight (1 - alpha^d)/(1 - alpha^D) after d of D blocks, alpha = exp(-1/tau), so they move fast at first
+    with a time constant of tau blocks and reach the next point exactly, then hold after the last one.
+    Both are convex combinations of stable sections, and the stability triangle of (a1, a2) is convex, so every block is stable.
+ */
+template<typename T> class CoefControl{
+
+    using Coefs = std::array<T,4>;   // b1 b2 a1 a2
+
+    private:
+
+        Interp _mode;
+
+        // decay of the exponential move per block
+        T _alpha;
+
+        // index of the next block
+        size_t _tile = 0;
+
+        // coefficients of the last block
+        Coefs _c;
+
+        // where the move to the next control point starts, the last reached control point or the last block when a point is
+        // added ahead of the moves.
+        size_t _from_tile = 0;
+        Coefs _from;
+
+        // future control points in the order of blocks
+        std::deque<std::pair<size_t,Coefs>> _points;
+
+    public:
+
+        CoefControl(){};
+
+        // Parameterized constructor, the coefficients [b0 b1 b2 a1 a2] of the first block, tau in blocks for the exponential move.
+        CoefControl(const T coefs[5], const Interp mode=Interp::linear, const T tau=1): _mode(mode),
+            _alpha(tau > 0 ? std::exp(T(-1)/tau) : T(0)), _c{coefs[1],coefs[2],coefs[3],coefs[4]}, _from(_c) {};
+
+        // add a control point [b0 b1 b2 a1 a2] at a block, a block that has been passed takes the next one instead.
+        inline void point(size_t tile, const T coefs[5]){
+
+            tile = std::max(tile, _tile);
+
+            // a new first point moves on from the coefficients of the last block, not from the last reached point.
+            if (_tile > 0 && (_points.empty() || tile < _points.front().first)){
+                _from = _c;
+                _from_tile = _tile - 1;
+            }
+
+            auto it = _points.begin();
+            while (it != _points.end() && it->first <= tile) it++;
+            _points.insert(it, std::make_pair(tile, Coefs{coefs[1],coefs[2],coefs[3],coefs[4]}));
+        };
+
+        // the coefficients of the next block, called once per block in the order of blocks.
+        inline Coefs next(){
+
+            size_t k = _tile++;
+
+            while (!_points.empty() && _points.front().first <= k){
+
+                _from_tile = _points.front().first;
+                _from = _points.front().second;
+                _points.pop_front();
+            }
+
+            if (_points.empty()){
+                _c = _from;
+            } else {
+
+                T d = T(k - _from_tile), D = T(_points.front().first - _from_tile);
+                T w = (_mode == Interp::linear) ? d/D : (1 - std::pow(_alpha, d))/(1 - std::pow(_alpha, D));
+
+                for (auto q=0; q<4; q++)
+                    _c[q] = _from[q] + w*(_points.front().second[q] - _from[q]);
+            }
+
+            return _c;
+        };
+
+        // index of the next block
+        inline size_t tile() const { return _tile; }
+
+};
+
+#endif // header guard
@@ -4,6 +4,8 @@
 #include <array>
 #include "vectorclass.h"
 #include <vector>
+#include <memory>
+#include "section_table.h"
 
 // A class of data block that encapsulates input samples, tag, initial values of sos. 
 template<typename V> struct DataBlock{
@@ -16,8 +18,11 @@ template<typename V> struct DataBlock{
     std::array<V,M> ori_data;
     std::array<T,2> x_inits; // 0: xi2, 1: xi1
     std::array<T,2> y_inits; // 0: yi2, 1: yi1
+    std::array<T,M> xp_inits, yp_inits;   // x_{-1} ... x_{-P}, y_{-1} ... y_{-P} of a section of order P <= M
     bool last = false;       // flag of the last data block
-    std::vector<T> post_inits;    // sos1: xi2, xi1, yi2, yi1, sos2: xi2, xi1, yi2, yi1
+    std::vector<T> post_inits;    // sos1: xi2, xi1, yi2, yi1, sos2: xi2, xi1, yi2, yi1, a section of order P: xi1 ... xiP, yi1 ... yiP
+    std::vector<T> pre_inits;     // sos1: xi1, xi2, yi1, yi2, sos2: ... only known when the first block is sent, each sos takes its own four, order P its 2P
+    std::shared_ptr<const TileTable<V>> tile;   // coefficients of the current section for this block if they vary over time
         
 };
 
@@ -0,0 +1,110 @@
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H 1
+
+#include "tbb_iir_multi_core.h"
+#include "runtime_series.h"
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <tbb/tbb.h>
+#include "simd_vec.h"
+
+/*
+    real function to user: a bank of K cascaded second order filters over one shared input, e.g., octave-band analysis.
+    Each block of input samples is loaded and transposed once in one graph and sent to the sections of all K cascades,
+    which write K output streams, so the loading and the setup of the graph do not grow with K.
+ */
+template<typename T> class FilterBank{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+    using arrayV = std::array<V,M>;
+
+    private:
+
+        // multi-core filter of each cascade, which keeps the tables and the state of its sections
+        std::vector<TBBIIRMultiCore<V>> _MC;
+
+        // single-core filter of each cascade, sharing the tables
+        std::vector<RuntimeSeries<V>> _S;
+
+    public:
+
+        // K cascades, coefs[k]: contiguous coefficients [b0 b1 b2 a1 a2] of the sections of cascade k, inits[k]: [xi1 xi2 yi1 yi2] of them.
+        FilterBank(const std::vector<std::vector<T>>& coefs,const std::vector<std::vector<T>>& inits){
+
+            assert(coefs.size() == inits.size());
+
+            for (size_t k=0;k<coefs.size();k++){
+
+                std::vector<std::shared_ptr<const SectionTable<V>>> tabs;
+                for (size_t i=0;i<coefs[k].size()/5;i++)
+                    tabs.push_back(make_section_table<V>(coefs[k].data() + 5*i));
+
+                _MC.emplace_back(tabs, inits[k].data());
+                _S.emplace_back(tabs, inits[k].data());
+            }
+        }
+
+    // filter len samples by every cascade, the outputs of cascade k are written to out[k]. The state of every cascade is kept.
+    inline void operator()(const T* in,const size_t len,const std::vector<T*>& out){
+
+        assert(out.size() == _MC.size());
+
+        size_t K = _MC.size();
+        size_t block_max = len/L;
+
+        // whole blocks go multi-core
+        if (block_max > 0){
+
+            // the multi-core filters continue from the state that the single-core filters have reached
+            for (size_t k=0;k<K;k++){
+
+                std::vector<T> inits(4*_MC[k].size());
+                _S[k].get_inits(inits.data());
+                _MC[k].set_inits(inits.data());
+            }
+
+            // load and transpose each block once for all the cascades
+            auto post_inits = TBBIIRMultiCore<V>::run_shared(_MC, block_max,
+                [&](size_t tag, arrayV& data){
+                    for (auto n = 0; n < M; n++)
+                        data[n].load(in + n*M + tag*L);
+                    data = _permuteV(data);
+                },
+                [&](size_t k, size_t tag, arrayV& data){
+                    data = _permuteV(data);
+                    for (auto n = 0; n < M; n++)
+                        data[n].store(out[k] + n*M + tag*L);
+                });
+
+            // the single-core filters continue from the state of the multi-core filters
+            for (size_t k=0;k<K;k++)
+                _S[k].inits_refresh(post_inits[k].data());
+        }
+
+        // the rest samples by the single-core filter of each cascade
+        size_t d = block_max*L;
+        tbb::parallel_for(size_t(0), K, [&](size_t k){
+
+            size_t n = d;
+            V x;
+            for (; n+M <= len; n += M){
+                x.load(in + n);
+                _S[k].series_option1(x).store(out[k] + n);
+            }
+
+            for (; n < len; n++)
+                out[k][n] = _S[k].series_scalar(in[n]);
+        });
+    }
+
+    // number of cascades
+    inline size_t size() const { return _MC.size(); }
+
+};
+
+#endif // header guard
@@ -0,0 +1,85 @@
+#ifndef FIR_HISTORY_H
+#define FIR_HISTORY_H 1
+
+#include <vector>
+#include <algorithm>
+#include "simd_vec.h"
+
+/*
+    a FIR over a stream that arrives in calls, fir[m] multiplies x_{n-m}. It keeps the last q = fir.size()-1 input samples
+    of the previous call, x_{-q}, ..., x_{-1}, so that the outputs after the first q of a call are taken straight from the
+    input in any order and in parallel, and only the first q outputs of a call reach back to the kept samples.
+ */
+template<typename T> class FirHistory{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::vector<T> _fir;
+
+        // the last input samples of the previous call, x_{-q}, ..., x_{-1}
+        std::vector<T> _hist;
+
+    public:
+
+        FirHistory(){};
+
+        FirHistory(const std::vector<T>& fir): _fir(fir), _hist(fir.empty() ? 0 : fir.size() - 1, 0){}
+
+    // the FIR from x[0], ..., x[len-1] to y[0], ..., y[len-1], or added to y if add, x[-q] ... x[-1] are valid.
+    inline void operator()(const T* x, T* y, const size_t len, const bool add=false) const {
+
+        size_t n = 0;
+        V v, w;
+
+        for (; n+M <= len; n += M){
+
+            if (add) w.load(y + n);
+            else w = V(0);
+
+            for (size_t m=0; m<_fir.size(); m++)
+                w = mul_add(v.load(x + n - m), _fir[m], w);
+            w.store(y + n);
+        }
+
+        for (; n < len; n++){
+
+            T s = add ? y[n] : T(0);
+            for (size_t m=0; m<_fir.size(); m++) s += _fir[m]*x[n - m];
+            y[n] = s;
+        }
+    }
+
+    /*
+        the first min(q, len) outputs of a call of len samples, which reach back to the kept samples, then keep the last q
+        samples for the next call. Returns the number of outputs, the rest is taken straight from in.
+     */
+    inline size_t head(const T* in, T* out, const size_t len, const bool add=false){
+
+        const size_t q = _hist.size(), h = std::min(q, len);
+
+        // only the first outputs are taken after _hist
+        std::vector<T> x(q + h);
+        std::copy(_hist.begin(), _hist.end(), x.begin());
+        std::copy(in, in + h, x.begin() + q);
+
+        (*this)(x.data() + q, out, h, add);
+
+        if (len >= q) std::copy(in + len - q, in + len, _hist.begin());
+        else std::copy(x.end() - q, x.end(), _hist.begin());
+
+        return h;
+    }
+
+    inline const std::vector<T>& taps() const { return _fir; }
+
+    // the kept samples x_{-q}, ..., x_{-1}, they may be set, e.g., from initial conditions.
+    inline std::vector<T>& history() { return _hist; }
+
+};
+
+#endif // header guard
@@ -0,0 +1,269 @@
+#ifndef FIRST_ORDER_CORES_H
+#define FIRST_ORDER_CORES_H 1
+
+#include <array>
+#include <memory>
+#include "vectorclass.h"
+#include "shift_reg.h"
+#include "permuteV.h"
+#include "first_order_table.h"
+
+// zero initial condition that calculates the particular part of the first order recursive equation.
+template<typename V> class ZeroInitCondOrderOne{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+        // shift register storing the pre-condition of particular part, i.e., x_{-1}.
+        Shift<V> _S;
+
+    public:
+
+        ZeroInitCondOrderOne(){};
+
+        ZeroInitCondOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab, const T xi1=0): _tab(std::move(tab)) {
+            _S.shift(xi1);
+        };
+
+        inline void inits_refresh(const T xi1){
+            _S.shift(xi1);
+        }
+
+        inline T inits() { return _S[-1]; }
+
+        inline void table_refresh(std::shared_ptr<const FirstOrderTable<V>> tab){
+            _tab = std::move(tab);
+        }
+
+        // calculate the particular part of recursive equation by scalar
+        inline T ZIC_S(const T x) {
+
+            T w = x + _tab->b1*_S[-1];
+            _S.shift(x);
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by block filtering
+        inline V ZIC_NT(const V x) {
+
+            const FirstOrderTable<V>& t = *_tab;
+
+            V w = t.p1*_S[-1];
+            for (auto n=0; n<M; n++) w = mul_add(t.H[n], x[n], w);
+
+            _S.shift(x);
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by multi-block filtering, each lane starts from zero output.
+        inline std::array<V,M> ZIC_T(const std::array<V,M>& x) {
+
+            const FirstOrderTable<V>& t = *_tab;
+            std::array<V,M> w;
+
+            // the block of initial conditions, xi1 = [x_{-1} x_{M-1} x_{2M-1} ...]
+            V xi1 = lane_shift<1>(x[M-1], _S[-1]);
+
+            w[0] = mul_add(xi1, t.b1, x[0]);
+            for (auto n=1; n<M; n++) {
+                w[n] = mul_add(x[n-1], t.b1, x[n]);
+                w[n] = mul_add(w[n-1], t.a1, w[n]);
+            }
+
+            _S.shift(x[M-1][M-1]);
+
+            return w;
+        };
+
+};
+
+// initial condition correction that calculates the homogeneous part of the first order recursive equation.
+template<typename V> class InitCondCorcOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+    constexpr static int K = FirstOrderTable<V>::K;
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+        // shift register storing the pre-condition of homogeneous part, i.e., y_{-1}.
+        Shift<V> _S;
+
+    public:
+
+        InitCondCorcOrderOne(){};
+
+        InitCondCorcOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab, const T yi1=0): _tab(std::move(tab)) {
+            _S.shift(yi1);
+        };
+
+        inline void inits_refresh(const T yi1){
+            _S.shift(yi1);
+        }
+
+        inline T inits() { return _S[-1]; }
+
+        inline void table_refresh(std::shared_ptr<const FirstOrderTable<V>> tab){
+            _tab = std::move(tab);
+        }
+
+        // the last samples of the lanes from zero output before each lane, v, to the outputs by recursive doubling over lanes,
+        // lane j adds a1^{M*S} times lane j-S in the recursion of stride S.
+        static inline V lanes(const FirstOrderTable<V>& t, V v) {
+
+            [&]<int... k>(std::integer_sequence<int, k...>) {
+                ((v = mul_add(lane_shift<(1 << k)>(v, T(0)), t.cs[k], v)), ...);
+            }(std::make_integer_sequence<int, K>{});
+
+            return v;
+        };
+
+        // calculate the homogeneous part of recursive equation by scalar
+        inline T ICC_S(const T w) {
+
+            T y = w + _tab->a1*_S[-1];
+            _S.shift(y);
+
+            return y;
+        };
+
+        // calculate the homogeneous part of recursive equation by block filtering
+        inline V ICC_NT(const V w) {
+
+            V y = mul_add(_tab->h1, _S[-1], w);
+            _S.shift(y);
+
+            return y;
+        };
+
+        // calculate the homogeneous part of recursive equation by multi-block filtering and recursive doubling.
+        inline std::array<V,M> ICC_T(const std::array<V,M>& w) {
+
+            const FirstOrderTable<V>& t = *_tab;
+            std::array<V,M> y;
+
+            // the last samples of the lanes from zero output before the block, plus the response of lane j to y_{-1}, a1^{M(j+1)}
+            y[M-1] = mul_add(t.hM, _S[-1], lanes(t, w[M-1]));
+
+            // the block of initial conditions, yi1 = [y_{-1} y_{M-1} y_{2M-1} ...]
+            V yi1 = lane_shift<1>(y[M-1], _S[-1]);
+
+            for (auto n=0; n<M-1; n++) y[n] = mul_add(yi1, t.h1[n], w[n]);
+
+            _S.shift(y[M-1][M-1]);
+
+            return y;
+        };
+
+};
+
+// first order core composed by zic and icc functions, with the same interface as IirCoreOrderTwo.
+template<typename V> class IirCoreOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+        ZeroInitCondOrderOne<V> _Zic;
+
+        InitCondCorcOrderOne<V> _Icc;
+
+    public:
+
+        IirCoreOrderOne(){};
+
+        IirCoreOrderOne(const T b1, const T a1, const T xi1=0, const T yi1=0): IirCoreOrderOne(make_first_order_table<V>(b1, a1), xi1, yi1) {};
+
+        // one row of sos coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2] as a second order section,
+        // b2, a2, xi2 and yi2 are not used.
+        IirCoreOrderOne(const T coefs[5], const T inits[4]): IirCoreOrderOne(make_first_order_table<V>(coefs), inits[0], inits[2]) {};
+
+        IirCoreOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab, const T xi1=0, const T yi1=0): _tab(std::move(tab)) {
+
+            _Zic = ZeroInitCondOrderOne<V>(_tab, xi1);
+            _Icc = InitCondCorcOrderOne<V>(_tab, yi1);
+        };
+
+        // refresh the initial conditions in the order of post_inits of the multi-core engine, [xi2 xi1 yi2 yi1].
+        inline void inits_refresh(const T inits[4]){
+
+            _Zic.inits_refresh(inits[1]);
+            _Icc.inits_refresh(inits[3]);
+        }
+
+        // the current initial conditions in the order of constructor, [xi1 xi2 yi1 yi2], where xi2 and yi2 are 0.
+        inline void get_inits(T inits[4]){
+
+            inits[0] = _Zic.inits();
+            inits[1] = 0;
+            inits[2] = _Icc.inits();
+            inits[3] = 0;
+        }
+
+        inline void table_refresh(std::shared_ptr<const FirstOrderTable<V>> tab){
+
+            _tab = std::move(tab);
+            _Zic.table_refresh(_tab);
+            _Icc.table_refresh(_tab);
+        }
+
+        inline const std::shared_ptr<const FirstOrderTable<V>>& table() const { return _tab; }
+
+        inline T benchmark(const T x) {
+            return _Icc.ICC_S(_Zic.ZIC_S(x));
+        };
+
+        // the option 1, block filtering: ZIC_NT - ICC_NT
+        inline V option1(const V x) {
+            return _Icc.ICC_NT(_Zic.ZIC_NT(x));
+        };
+
+        // the option 2, mixed filtering: T - ZIC_T - T - ICC_NT
+        inline std::array<V,M> option2(const std::array<V,M>& x) {
+            return option2_tail(_permuteV(x));
+        };
+
+        // the option 3, multi-block filtering: T - ZIC_T - ICC_T - T
+        inline std::array<V,M> option3(const std::array<V,M>& x) {
+            return _permuteV(option3_middle(_permuteV(x)));
+        };
+
+        inline std::array<V,M> option2_tail(const std::array<V,M>& x_T) {
+
+            std::array<V,M> w = _permuteV(_Zic.ZIC_T(x_T));
+
+            std::array<V,M> y;
+            for (auto n=0; n<M; n++) y[n] = _Icc.ICC_NT(w[n]);
+
+            return y;
+        };
+
+        inline std::array<V,M> option3_head(const std::array<V,M>& x) {
+            return option3_middle(_permuteV(x));
+        };
+
+        inline std::array<V,M> option3_tail(const std::array<V,M>& x_T) {
+            return _permuteV(option3_middle(x_T));
+        };
+
+        inline std::array<V,M> option3_middle(const std::array<V,M>& x_T) {
+            return _Icc.ICC_T(_Zic.ZIC_T(x_T));
+        };
+
+};
+
+#endif // header guard
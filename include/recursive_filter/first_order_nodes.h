@@ -0,0 +1,158 @@
+#ifndef FIRST_ORDER_NODES_H
+#define FIRST_ORDER_NODES_H 1
+
+#include <vector>
+#include "vectorclass.h"
+#include "data_block.h"
+#include "first_order_table.h"
+#include "first_order_cores_serial.h"
+
+/*
+    the stages of a first order section in the multi-core graph, in the same places as NoStateZIC, RecurDoubV, InterBlockRD and
+    ICCForward of a second order section. InitAdder, the sequencers and Buffer are shared, post_inits keep 4 values per section
+    in the order xi2, xi1, yi2, yi1, where yi2 is 0.
+ */
+
+// Stateless zero initial condition of a first order section, each lane of the transposed block starts from zero output.
+template<typename V> class NoStateZICOrderOne{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+    public:
+
+        NoStateZICOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in) {
+
+            const FirstOrderTable<V>& t = *_tab;
+
+            if (in.last){
+
+                in.post_inits.push_back(in.data[M-2][M-1]);
+                in.post_inits.push_back(in.data[M-1][M-1]);
+            };
+
+            std::array<V,M> w;
+
+            V xi1 = lane_shift<1>(in.data[M-1], in.x_inits[1]);
+
+            w[0] = mul_add(xi1, t.b1, in.data[0]);
+            for (auto n=1; n<M; n++) {
+                w[n] = mul_add(in.data[n-1], t.b1, in.data[n]);
+                w[n] = mul_add(w[n-1], t.a1, w[n]);
+            }
+
+            in.data = w;
+
+            return in;
+        };
+
+};
+
+// stateless recursive doubling over the lanes of the last vector of a block, from zero output before the block.
+template<typename V> class RecurDoubVOrderOne{
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+    public:
+
+        RecurDoubVOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in){
+
+            in.data[M-1] = InitCondCorcOrderOne<V>::lanes(*_tab, in.data[M-1]);
+
+            return in;
+        };
+
+};
+
+/*
+    the output before each of the buffered blocks, y_inits[1]. The last output of a block is its last output from zero output
+    before the block plus a1^{M*M} times the output before the block, which is one multiply-add per block in order.
+ */
+template <typename V> class InterBlockRDOrderOne: public tbb::flow::multifunction_node<std::vector<DataBlock<V>>, std::tuple<DataBlock<V>>> {
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+        T _y;
+
+    public:
+
+        InterBlockRDOrderOne(tbb::flow::graph& g, std::shared_ptr<const FirstOrderTable<V>> tab, T yi1)
+        :tbb::flow::multifunction_node<std::vector<DataBlock<V>>, std::tuple<DataBlock<V>>>(
+            g, tbb::flow::serial,
+            [this](const std::vector<DataBlock<V>>& in, typename InterBlockRDOrderOne::output_ports_type& ports){
+
+                const T cL = this->_tab->cL;
+
+                // the initial condition that is only known when the first block is sent
+                if (!in[0].pre_inits.empty()) _y = in[0].pre_inits[2];
+
+                for (DataBlock<V> data: in) {
+
+                    data.y_inits[0] = 0;
+                    data.y_inits[1] = _y;
+
+                    _y = cL*_y + data.data[M-1][M-1];
+
+                    if (data.last){
+
+                        data.post_inits.push_back(0);
+                        data.post_inits.push_back(_y);
+                    };
+
+                    if (!data.pre_inits.empty())
+                        data.pre_inits.erase(data.pre_inits.begin(), data.pre_inits.begin() + 4);
+
+                    std::get<0>(ports).try_put(data);
+                }
+            }),
+            _tab(std::move(tab)), _y(yi1) {}
+
+};
+
+// (stateless) correct the blocks of a first order section from the output before the block.
+template<typename V> class ICCForwardOrderOne{
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const FirstOrderTable<V>> _tab;
+
+    public:
+
+        ICCForwardOrderOne(std::shared_ptr<const FirstOrderTable<V>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in){
+
+            const FirstOrderTable<V>& t = *_tab;
+
+            in.data[M-1] = mul_add(t.hM, in.y_inits[1], in.data[M-1]);
+
+            V yi1 = lane_shift<1>(in.data[M-1], in.y_inits[1]);
+
+            for (auto n=0; n<M-1; n++)
+                in.data[n] = mul_add(yi1, t.h1[n], in.data[n]);
+
+            return in;
+        };
+
+};
+
+#endif // header guard
@@ -0,0 +1,90 @@
+#ifndef FIRST_ORDER_TABLE_H
+#define FIRST_ORDER_TABLE_H 1
+
+#include <array>
+#include <memory>
+#include "vectorclass.h"
+
+/*
+    Immutable pre-computed table of one first order section y_n = x_n + b_1x_{n-1} + a_1y_{n-1}, i.e., a real pole and a real
+    zero, shared by every stage of the serial and multi-core engines. The state is a single value, so the powers of the 2x2
+    matrix C of a second order section become the powers of a_1.
+ */
+template<typename V> struct alignas(64) FirstOrderTable{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    // K: number of recursions in recursive doubling over M lanes, i.e., log2(M).
+    constexpr static int K = (M == 2) ? 1 : (M == 4) ? 2 : (M == 8) ? 3 : 4;
+
+    T b1, a1;
+
+    // responses of a block to x_{-1} and y_{-1}, p1 = [b1 b1a1 b1a1^2 ...], h1 = [a1 a1^2 ... a1^M].
+    V p1, h1;
+
+    // responses of the last samples of the lanes of a transposed block to y_{-1}, [a1^M a1^{2M} ... a1^{M*M}].
+    V hM;
+
+    // powers of a1^M for recursive doubling over lanes, cs[k] = a1^{M*2^k}
+    std::array<T,K> cs;
+
+    // power of a1 over a whole block, a1^{M*M}, for the recursion between blocks.
+    T cL;
+
+    // M by M lower triangular toeplitz matrix works for block filtering.
+    std::array<V,M> H;
+
+    FirstOrderTable(const T b1_, const T a1_): b1(b1_), a1(a1_) {
+
+        T p[M], h[M], hm[M], g[2*M] = {0};
+
+        T an = 1;
+        for (auto n=0; n<M; n++){
+            p[n] = b1*an;
+            an *= a1;
+            h[n] = an;
+        }
+
+        // an = a1^M
+        T am = 1;
+        for (auto j=0; j<M; j++){
+            am *= an;
+            hm[j] = am;
+        }
+
+        p1.load(p);
+        h1.load(h);
+        hM.load(hm);
+        cL = hm[M-1];
+
+        cs[0] = an;
+        for (auto k=1; k<K; k++) cs[k] = cs[k-1]*cs[k-1];
+
+        // the impulse response, 1, a1 + b1, a1(a1 + b1), ..., and the rest columns are shifted by 1 position in H
+        g[M] = 1;
+        for (auto n=1; n<M; n++) g[M+n] = h[n-1] + p[n-1];
+
+        for (auto n=0; n<M; n++) H[n].load(&g[M-n]);
+    };
+
+};
+
+// build a table of a first order section from one row of sos coefficients [b0 b1 b2 a1 a2], b2 and a2 are not used.
+template<typename V, typename T> inline std::shared_ptr<const FirstOrderTable<V>> make_first_order_table(const T coefs[5]) {
+    return std::make_shared<const FirstOrderTable<V>>(coefs[1], coefs[3]);
+};
+
+template<typename V, typename T> inline std::shared_ptr<const FirstOrderTable<V>> make_first_order_table(const T b1, const T a1) {
+    return std::make_shared<const FirstOrderTable<V>>(b1, a1);
+};
+
+// a row of sos coefficients [b0 b1 b2 a1 a2] that is a first order section, i.e., b2 = a2 = 0.
+template<typename T> inline bool is_first_order(const T b2, const T a2) {
+    return b2 == 0 && a2 == 0;
+};
+
+#endif // header guard
@@ -0,0 +1,188 @@
+#ifndef HALFBAND_FILTER_H
+#define HALFBAND_FILTER_H 1
+
+#include <vector>
+#include <cassert>
+#include <tbb/tbb.h>
+#include "allpass_cores_serial.h"
+#include "tbb_iir_multi_core.h"
+#include "simd_vec.h"
+
+/*
+    one phase of a polyphase half-band filter, H(z) = (A0(z^2) + z^{-1} A1(z^2))/2, where each Ak is a cascade of first order
+    allpass sections (c + z^{-2})/(1 + c z^{-2}) at the high rate. At the low rate they are (c + z^{-1})/(1 + c z^{-1}), and two
+    of them are merged into one second order allpass section, so a phase of n coefficients runs (n+1)/2 allpass sections. The
+    tiles run on the multi-core graph with the allpass zic, and the samples after the last tile on the serial cores.
+ */
+template<typename V> class AllpassPhase{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+
+    private:
+
+        std::vector<IirCoreAllpass<V>> _ap;
+
+        TBBIIRMultiCore<V> _MC;
+
+        static std::vector<std::shared_ptr<const AllpassTable<V>>> make_tables(const T* c, const int n){
+
+            std::vector<std::shared_ptr<const AllpassTable<V>>> tabs;
+
+            for (int i=0; i<n; i+=2){
+
+                if (i+1 < n) tabs.push_back(make_allpass_table<V>(-(c[i] + c[i+1]), -c[i]*c[i+1]));
+                else tabs.push_back(make_allpass_table<V>(-c[i], T(0)));
+            }
+
+            return tabs;
+        }
+
+    public:
+
+        // the serial cores and the graph share the tables of the sections, both start from rest.
+        AllpassPhase(const std::vector<std::shared_ptr<const AllpassTable<V>>>& tabs): _MC(tabs, std::vector<T>(4*tabs.size(), T(0)).data()){
+
+            for (auto& t: tabs) _ap.emplace_back(t);
+        }
+
+        // n coefficients c of the first order allpass sections in z^2, none of them is 0.
+        AllpassPhase(const T* c, const int n): AllpassPhase(make_tables(c, n)){}
+
+        // filter the samples of x at the low rate in place, the state is kept for the next call.
+        inline void operator()(std::vector<T>& x){
+
+            const size_t len = x.size(), tiles = len/L*L;
+
+            if (tiles > 0){
+
+                // the graph continues from the state of the serial cores and hands its state back
+                std::vector<T> inits(4*_ap.size()), rest(x.begin() + tiles, x.end());
+                for (size_t i=0; i<_ap.size(); i++) _ap[i].get_inits(&inits[4*i]);
+
+                _MC.set_inits(inits.data());
+
+                x.resize(tiles);
+                auto r = _MC(std::move(x));
+
+                x = std::move(r.first);
+                x.insert(x.end(), rest.begin(), rest.end());
+
+                for (size_t i=0; i<_ap.size(); i++) _ap[i].inits_refresh(&r.second[4*i]);
+            }
+
+            size_t n = tiles;
+
+            V v;
+            for (; n+M <= len; n += M){
+
+                v.load(&x[n]);
+                for (auto& ap: _ap) v = ap.option1(v);
+                v.store(&x[n]);
+            }
+
+            for (; n < len; n++)
+                for (auto& ap: _ap) x[n] = ap.benchmark(x[n]);
+        }
+
+        inline size_t size() const { return _ap.size(); }
+
+};
+
+/*
+    real function to user: decimation by 2 with a polyphase half-band allpass filter, y_m = (A0(x)_{2m} + A1(x)_{2m-1})/2. The
+    even and the odd input samples are filtered by their own phase at the low rate, so only the kept outputs are computed, and
+    the graphs of the two phases run at the same time.
+ */
+template<typename T> class HalfbandDecimator{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+
+    private:
+
+        AllpassPhase<V> _A0, _A1;
+
+        // the last odd input sample of the previous call, x_{-1}
+        T _x1 = 0;
+
+    public:
+
+        // the coefficients of the phases, c0[n0] and c1[n1]
+        HalfbandDecimator(const T* c0,const int n0,const T* c1,const int n1): _A0(c0,n0),_A1(c1,n1){}
+
+        HalfbandDecimator(const std::vector<T>& c0,const std::vector<T>& c1): HalfbandDecimator(c0.data(),c0.size(),c1.data(),c1.size()){}
+
+    // decimate len input samples into len/2 output samples, len is even. The state is kept for the next call.
+    inline void operator()(const T* in,T* out,const size_t len){
+
+        assert(len%2 == 0);
+
+        const size_t half = len/2;
+        if (half == 0) return;
+
+        std::vector<T> e(half), o(half);
+        for (size_t m=0; m<half; m++){
+
+            e[m] = in[2*m];
+            o[m] = (m == 0) ? _x1 : in[2*m-1];
+        }
+
+        _x1 = in[len-1];
+
+        tbb::parallel_invoke([&]{ _A0(e); }, [&]{ _A1(o); });
+
+        size_t m = 0;
+        V a, b;
+        for (; m+M <= half; m += M){
+
+            a.load(&e[m]);
+            b.load(&o[m]);
+            ((a + b)*T(0.5)).store(out + m);
+        }
+
+        for (; m < half; m++) out[m] = (e[m] + o[m])*T(0.5);
+    }
+
+};
+
+/*
+    real function to user: interpolation by 2 with a polyphase half-band allpass filter, y_{2m} = A0(x)_m, y_{2m+1} = A1(x)_m,
+    i.e., 2H(z) over the zero-stuffed input. Every input sample is filtered by both phases at the low rate, whose graphs run at
+    the same time, and no product with the stuffed zeros is computed.
+ */
+template<typename T> class HalfbandInterpolator{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    private:
+
+        AllpassPhase<V> _A0, _A1;
+
+    public:
+
+        HalfbandInterpolator(const T* c0,const int n0,const T* c1,const int n1): _A0(c0,n0),_A1(c1,n1){}
+
+        HalfbandInterpolator(const std::vector<T>& c0,const std::vector<T>& c1): HalfbandInterpolator(c0.data(),c0.size(),c1.data(),c1.size()){}
+
+    // interpolate len input samples into 2*len output samples. The state is kept for the next call.
+    inline void operator()(const T* in,T* out,const size_t len){
+
+        std::vector<T> e(in, in + len), o(in, in + len);
+
+        tbb::parallel_invoke([&]{ _A0(e); }, [&]{ _A1(o); });
+
+        for (size_t m=0; m<len; m++){
+
+            out[2*m] = e[m];
+            out[2*m+1] = o[m];
+        }
+    }
+
+};
+
+#endif // header guard
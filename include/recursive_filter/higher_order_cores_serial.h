@@ -0,0 +1,538 @@
+#ifndef HIGHER_ORDER_CORES_H
+#define HIGHER_ORDER_CORES_H 1
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "matrix_ops.h"
+
+/*
+    Immutable pre-computed table of one section of order P in direct form,
+    y_n = x_n + b_1x_{n-1} + ... + b_Px_{n-P} + a_1y_{n-1} + ... + a_Py_{n-P},
+    the generalization of SectionTable from the 2x2 matrix C to the P x P matrix Phi that moves the last P outputs of a row of
+    M samples, [y_{-1} ... y_{-P}], to the last P outputs of the next row, [y_{M-1} ... y_{M-P}].
+ */
+template<typename V, int P> struct alignas(64) HigherOrderTable{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    // K: number of recursions in recursive doubling over M lanes, i.e., log2(M).
+    constexpr static int K = (M == 2) ? 1 : (M == 4) ? 2 : (M == 8) ? 3 : 4;
+
+    static_assert(P <= M, "the last P outputs of a row of M samples are the state of the next row");
+
+    std::array<T,P> b, a;
+
+    // responses of a row of M samples to x_{-k} with zero outputs before, px[k-1], and to y_{-k} with zero inputs, hy[k-1].
+    std::array<V,P> px, hy;
+
+    // M by M lower triangular toeplitz matrix works for block filtering.
+    std::array<V,M> H;
+
+    // Phi^{2^k} for recursive doubling over lanes, row major
+    std::array<std::array<T,P*P>,K> phi;
+
+    // the elements of Phi^{j+1} in lane j, [p*P+q]
+    std::array<V,P*P> phi_lanes;
+
+    // Phi^{M*2^k} for recursive doubling over blocks of M rows, and the elements of Phi^{M(j+1)} in lane j
+    std::array<std::array<T,P*P>,K> phi_blocks;
+    std::array<V,P*P> blocks_lanes;
+
+    // b = [b1 ... bP], a = [a1 ... aP]
+    HigherOrderTable(const T* b_, const T* a_) {
+
+        for (auto k=0; k<P; k++){
+            b[k] = b_[k];
+            a[k] = a_[k];
+        }
+
+        // the responses by running the recursive equation from a single non-zero x_{-k} or y_{-k}
+        T g[2*M] = {0};
+        for (auto k=0; k<=2*P; k++){
+
+            T x[M+P] = {0}, y[M+P] = {0};
+
+            if (k == 0) x[P] = 1;
+            else if (k <= P) x[P-k] = 1;
+            else y[P-(k-P)] = 1;
+
+            for (auto n=0; n<M; n++){
+                T s = x[P+n];
+                for (auto i=1; i<=P; i++) s += b[i-1]*x[P+n-i] + a[i-1]*y[P+n-i];
+                y[P+n] = s;
+            }
+
+            if (k == 0) for (auto n=0; n<M; n++) g[M+n] = y[P+n];
+            else if (k <= P) px[k-1].load(&y[P]);
+            else hy[k-P-1].load(&y[P]);
+        }
+
+        for (auto n=0; n<M; n++) H[n].load(&g[M-n]);
+
+        // Phi[p][q]: output y_{M-1-p} of a row from y_{-1-q}
+        std::array<T,P*P> F;
+        for (auto p=0; p<P; p++)
+            for (auto q=0; q<P; q++)
+                F[p*P+q] = hy[q][M-1-p];
+
+        phi[0] = F;
+        for (auto k=1; k<K; k++) phi[k] = _mul(phi[k-1], phi[k-1]);
+
+        std::array<T,P*P> Fj = F;
+        T lanes[P*P][M];
+        for (auto j=0; j<M; j++){
+            for (auto i=0; i<P*P; i++) lanes[i][j] = Fj[i];
+            Fj = _mul(Fj, F);
+        }
+
+        for (auto i=0; i<P*P; i++) phi_lanes[i].load(lanes[i]);
+
+        phi_blocks[0] = _mul(phi[K-1], phi[K-1]);
+        for (auto k=1; k<K; k++) phi_blocks[k] = _mul(phi_blocks[k-1], phi_blocks[k-1]);
+
+        Fj = phi_blocks[0];
+        for (auto j=0; j<M; j++){
+            for (auto i=0; i<P*P; i++) lanes[i][j] = Fj[i];
+            Fj = _mul(Fj, phi_blocks[0]);
+        }
+
+        for (auto i=0; i<P*P; i++) blocks_lanes[i].load(lanes[i]);
+    };
+
+    // lane j of z adds G^{j-i} times the lane i < j by recursive doubling, F[k] = G^{2^k}, e.g., G = Phi over the rows of a block.
+    static inline void doubling(const std::array<std::array<T,P*P>,K>& F, std::array<V,P>& z) {
+
+        [&]<int... k>(std::integer_sequence<int, k...>) {
+            (_join<(1 << k)>(F[k], z), ...);
+        }(std::make_integer_sequence<int, K>{});
+    };
+
+    // z[p] += G[p*P+q] s[q], the response of the lanes to the state s before them, G holds the powers of Phi lane by lane.
+    static inline void add_lanes(const std::array<V,P*P>& G, const T* s, std::array<V,P>& z) {
+
+        for (auto p=0; p<P; p++)
+            for (auto q=0; q<P; q++)
+                z[p] = mul_add(G[p*P+q], s[q], z[p]);
+    };
+
+    // lane j adds F times the lane j-S in the recursion of stride S.
+    template<int S> static inline void _join(const std::array<T,P*P>& F, std::array<V,P>& z) {
+
+        std::array<V,P> zs;
+        for (auto q=0; q<P; q++) zs[q] = lane_shift<S>(z[q], T(0));
+
+        for (auto p=0; p<P; p++)
+            for (auto q=0; q<P; q++)
+                z[p] = mul_add(zs[q], F[p*P+q], z[p]);
+    };
+
+    static inline std::array<T,P*P> _mul(const std::array<T,P*P>& A, const std::array<T,P*P>& B) {
+
+        std::array<T,P*P> C{};
+        for (auto p=0; p<P; p++)
+            for (auto q=0; q<P; q++)
+                for (auto r=0; r<P; r++)
+                    C[p*P+q] += A[p*P+r]*B[r*P+q];
+
+        return C;
+    };
+
+};
+
+// build a table from one row of coefficients of a section of order P, [b0 b1 ... bP a1 ... aP]
+template<typename V, int P, typename T> inline std::shared_ptr<const HigherOrderTable<V,P>> make_higher_order_table(const T* coefs) {
+    return std::make_shared<const HigherOrderTable<V,P>>(coefs + 1, coefs + 1 + P);
+};
+
+// zero initial condition that calculates the particular part of the recursive equation of order P.
+template<typename V, int P> class ZeroInitCondOrderP{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+        // the pre-conditions of particular part, x_{-1}, ..., x_{-P}.
+        std::array<T,P> _x;
+
+    public:
+
+        ZeroInitCondOrderP(){};
+
+        ZeroInitCondOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab, const T* xi): _tab(std::move(tab)) {
+            inits_refresh(xi);
+        };
+
+        inline void inits_refresh(const T* xi){
+            for (auto k=0; k<P; k++) _x[k] = xi[k];
+        }
+
+        inline const std::array<T,P>& inits() const { return _x; }
+
+        // calculate the particular part of recursive equation by scalar
+        inline T ZIC_S(const T x) {
+
+            const HigherOrderTable<V,P>& t = *_tab;
+
+            T w = x;
+            for (auto k=P-1; k>=0; k--){
+                w += t.b[k]*_x[k];
+                _x[k] = (k == 0) ? x : _x[k-1];
+            }
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by block filtering
+        inline V ZIC_NT(const V x) {
+
+            const HigherOrderTable<V,P>& t = *_tab;
+
+            V w{0};
+            for (auto n=0; n<M; n++) w = mul_add(t.H[n], x[n], w);
+            for (auto k=0; k<P; k++) w = mul_add(t.px[k], _x[k], w);
+
+            for (auto k=0; k<P; k++) _x[k] = x[M-1-k];
+
+            return w;
+        };
+
+        // calculate the particular part of recursive equation by multi-block filtering, each lane starts from zero output.
+        inline std::array<V,M> ZIC_T(const std::array<V,M>& x) {
+
+            std::array<V,M> w = kernel(*_tab, x, _x.data());
+
+            for (auto k=1; k<=P; k++) _x[k-1] = x[M-k][M-1];
+
+            return w;
+        };
+
+        // the kernel of multi-block filtering on a transposed block, xi = [x_{-1} ... x_{-P}] before the block.
+        static inline std::array<V,M> kernel(const HigherOrderTable<V,P>& t, const std::array<V,M>& x, const T* xi) {
+
+            std::array<V,M> w;
+
+            // the blocks of initial conditions, xh[k-1] = [x_{-k} x_{M-k} x_{2M-k} ...]
+            std::array<V,P> xh;
+            for (auto k=1; k<=P; k++) xh[k-1] = lane_shift<1>(x[M-k], xi[k-1]);
+
+            for (auto n=0; n<M; n++){
+
+                w[n] = x[n];
+                for (auto k=1; k<=P; k++){
+                    w[n] = mul_add((n >= k) ? x[n-k] : xh[k-n-1], t.b[k-1], w[n]);
+                    if (n >= k) w[n] = mul_add(w[n-k], t.a[k-1], w[n]);
+                }
+            }
+
+            return w;
+        };
+
+};
+
+// initial condition correction that calculates the homogeneous part of the recursive equation of order P.
+template<typename V, int P> class InitCondCorcOrderP{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+        // the pre-conditions of homogeneous part, y_{-1}, ..., y_{-P}.
+        std::array<T,P> _y;
+
+    public:
+
+        InitCondCorcOrderP(){};
+
+        InitCondCorcOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab, const T* yi): _tab(std::move(tab)) {
+            inits_refresh(yi);
+        };
+
+        inline void inits_refresh(const T* yi){
+            for (auto k=0; k<P; k++) _y[k] = yi[k];
+        }
+
+        inline const std::array<T,P>& inits() const { return _y; }
+
+        // calculate the homogeneous part of recursive equation by scalar
+        inline T ICC_S(const T w) {
+
+            const HigherOrderTable<V,P>& t = *_tab;
+
+            T y = w;
+            for (auto k=P-1; k>=0; k--) y += t.a[k]*_y[k];
+            for (auto k=P-1; k>0; k--) _y[k] = _y[k-1];
+            _y[0] = y;
+
+            return y;
+        };
+
+        // calculate the homogeneous part of recursive equation by block filtering
+        inline V ICC_NT(const V w) {
+
+            const HigherOrderTable<V,P>& t = *_tab;
+
+            V y = w;
+            for (auto k=0; k<P; k++) y = mul_add(t.hy[k], _y[k], y);
+
+            for (auto k=0; k<P; k++) _y[k] = y[M-1-k];
+
+            return y;
+        };
+
+        // calculate the homogeneous part of recursive equation by multi-block filtering and recursive doubling over lanes.
+        inline std::array<V,M> ICC_T(const std::array<V,M>& w) {
+
+            const HigherOrderTable<V,P>& t = *_tab;
+            std::array<V,M> y = w;
+
+            // the last P outputs of the lanes from zero output before the block, z[p] = [y_{M-1-p} y_{2M-1-p} ...]
+            std::array<V,P> z;
+            for (auto p=0; p<P; p++) z[p] = w[M-1-p];
+
+            t.doubling(t.phi, z);
+            correct(t, y, z, _y.data());
+
+            for (auto q=0; q<P; q++) _y[q] = y[M-1-q][M-1];
+
+            return y;
+        };
+
+        /*
+            correct the particular part w of a transposed block in place by the outputs yi = [y_{-1} ... y_{-P}] before the block.
+            z: the last P rows of the block after recursive doubling over lanes from zero output, which become the last P rows.
+         */
+        static inline void correct(const HigherOrderTable<V,P>& t, std::array<V,M>& w, std::array<V,P> z, const T* yi) {
+
+            // the response of lane j to the outputs before the block, Phi^{j+1}
+            t.add_lanes(t.phi_lanes, yi, z);
+
+            // the blocks of initial conditions, yl[q] = [y_{-1-q} y_{M-1-q} y_{2M-1-q} ...]
+            std::array<V,P> yl;
+            for (auto q=0; q<P; q++) yl[q] = lane_shift<1>(z[q], yi[q]);
+
+            for (auto n=0; n<M-P; n++)
+                for (auto q=0; q<P; q++) w[n] = mul_add(yl[q], t.hy[q][n], w[n]);
+
+            for (auto p=0; p<P; p++) w[M-1-p] = z[p];
+        };
+
+};
+
+/*
+    core of a section of order P composed by zic and icc functions, with the options of IirCoreOrderTwo, so that it can be
+    cascaded in Series, e.g., two second order sections merged into one of order 4 halve the stages of the cascade.
+    Coefficients [b0 b1 ... bP a1 ... aP] (b0 is not used) and initial conditions [xi1 ... xiP yi1 ... yiP].
+ */
+template<typename V, int P> class IirCoreOrderP{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+        ZeroInitCondOrderP<V,P> _Zic;
+
+        InitCondCorcOrderP<V,P> _Icc;
+
+    public:
+
+        IirCoreOrderP(){};
+
+        IirCoreOrderP(const T* coefs, const T* inits): IirCoreOrderP(make_higher_order_table<V,P>(coefs), inits) {};
+
+        IirCoreOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab, const T* inits): _tab(std::move(tab)) {
+
+            _Zic = ZeroInitCondOrderP<V,P>(_tab, inits);
+            _Icc = InitCondCorcOrderP<V,P>(_tab, inits + P);
+        };
+
+        // refresh the initial conditions, [xi1 ... xiP yi1 ... yiP].
+        inline void inits_refresh(const T* inits){
+
+            _Zic.inits_refresh(inits);
+            _Icc.inits_refresh(inits + P);
+        }
+
+        // the current initial conditions, [xi1 ... xiP yi1 ... yiP].
+        inline void get_inits(T* inits){
+
+            for (auto k=0; k<P; k++){
+                inits[k] = _Zic.inits()[k];
+                inits[P+k] = _Icc.inits()[k];
+            }
+        }
+
+        inline const std::shared_ptr<const HigherOrderTable<V,P>>& table() const { return _tab; }
+
+        inline T benchmark(const T x) {
+            return _Icc.ICC_S(_Zic.ZIC_S(x));
+        };
+
+        // the option 1, block filtering: ZIC_NT - ICC_NT
+        inline V option1(const V x) {
+            return _Icc.ICC_NT(_Zic.ZIC_NT(x));
+        };
+
+        // the option 2, mixed filtering: T - ZIC_T - T - ICC_NT
+        inline std::array<V,M> option2(const std::array<V,M>& x) {
+            return option2_tail(_permuteV(x));
+        };
+
+        // the option 3, multi-block filtering: T - ZIC_T - ICC_T - T
+        inline std::array<V,M> option3(const std::array<V,M>& x) {
+            return _permuteV(option3_middle(_permuteV(x)));
+        };
+
+        inline std::array<V,M> option2_tail(const std::array<V,M>& x_T) {
+
+            std::array<V,M> w = _permuteV(_Zic.ZIC_T(x_T));
+
+            std::array<V,M> y;
+            for (auto n=0; n<M; n++) y[n] = _Icc.ICC_NT(w[n]);
+
+            return y;
+        };
+
+        inline std::array<V,M> option3_head(const std::array<V,M>& x) {
+            return option3_middle(_permuteV(x));
+        };
+
+        inline std::array<V,M> option3_tail(const std::array<V,M>& x_T) {
+            return _permuteV(option3_middle(x_T));
+        };
+
+        inline std::array<V,M> option3_middle(const std::array<V,M>& x_T) {
+            return _Icc.ICC_T(_Zic.ZIC_T(x_T));
+        };
+
+};
+
+template<typename V> using IirCoreOrderFour = IirCoreOrderP<V,4>;
+template<typename V> using IirCoreOrderSix = IirCoreOrderP<V,6>;
+
+/*
+    a core of any order behind the same interface, e.g., the merged sections of a cascade that is only known at runtime. The
+    functions share one core, inits in the order of IirCoreOrderP, [xi1 ... xiP yi1 ... yiP].
+ */
+template<typename V> struct AnyOrderCore{
+
+    using T = decltype(std::declval<V>().extract(0));
+
+    int order;
+    std::function<T(T)> scalar;
+    std::function<V(V)> option1;
+    std::function<void(T*)> get_inits;
+    std::function<void(const T*)> inits_refresh;
+};
+
+template<typename V, int P> inline AnyOrderCore<V> any_order_core(std::shared_ptr<const HigherOrderTable<V,P>> tab, const typename HigherOrderTable<V,P>::T* inits) {
+
+    using T = typename HigherOrderTable<V,P>::T;
+    auto c = std::make_shared<IirCoreOrderP<V,P>>(std::move(tab), inits);
+
+    return {P, [c](T x){ return c->benchmark(x); }, [c](V x){ return c->option1(x); },
+            [c](T* i){ c->get_inits(i); }, [c](const T* i){ c->inits_refresh(i); }};
+};
+
+// y_n = b_0x_n + b_1x_{n-1} + ... + a_1y_{n-1} + a_2y_{n-2} + ... from rest, in double.
+inline std::vector<double> _direct_form(const std::vector<double>& b, const std::vector<double>& a, const std::vector<double>& x) {
+
+    std::vector<double> y(x.size(), 0);
+    for (size_t n=0; n<x.size(); n++){
+        for (size_t k=0; k<b.size() && k<=n; k++) y[n] += b[k]*x[n-k];
+        for (size_t k=1; k<=a.size() && k<=n; k++) y[n] += a[k-1]*y[n-k];
+    }
+
+    return y;
+};
+
+/*
+    merge every P/2 consecutive second order sections of contiguous coefficients [b0 b1 b2 a1 a2] into one section of order P,
+    [b0 b1 ... bP a1 ... aP], by multiplying their numerators and denominators. The poles of a merged section are the roots of
+    one polynomial of order P, which is more sensitive to rounding than the roots of P/2 polynomials of order 2, so every merged
+    section is checked: the impulse responses over len samples of the merged coefficients rounded to T and of the cascade of
+    its sections are computed in double, and if the largest difference exceeds tol times the peak of the cascade, the sections
+    stay second order. They go to rest in the order of coefs, with the sections that do not fill a group of P/2, and rest is
+    required then. Returns the merged sections, which come first in the cascade.
+ */
+template<int P, typename T> inline std::vector<T> merge_sections(const T* coefs, const int n, std::vector<T>* rest=nullptr,
+                                                                 const double tol=std::sqrt(std::numeric_limits<T>::epsilon()), const int len=1024) {
+
+    static_assert(P % 2 == 0, "a merged section is made of second order sections");
+
+    std::vector<T> merged;
+
+    std::vector<double> impulse(len, 0);
+    impulse[0] = 1;
+
+    // the sections i, ..., i+m-1 stay second order
+    auto keep = [&](const int i, const int m){
+
+        assert(rest && "the sections that stay second order are returned in rest");
+        rest->insert(rest->end(), coefs + 5*i, coefs + 5*(i+m));
+    };
+
+    for (int i=0; i<n; i+=P/2){
+
+        const int m = std::min(P/2, n-i);
+
+        if (m < P/2){
+            keep(i, m);
+            break;
+        }
+
+        // numerator 1 + b1 z^{-1} + ..., denominator 1 - a1 z^{-1} - ..., and the impulse response of the cascade
+        std::vector<double> num{1}, den{1}, h = impulse;
+
+        for (int s=i; s<i+m; s++){
+
+            const T* c = coefs + 5*s;
+            num = _poly_mul(num, {1, double(c[1]), double(c[2])});
+            den = _poly_mul(den, {1, -double(c[3]), -double(c[4])});
+            h = _direct_form({1, double(c[1]), double(c[2])}, {double(c[3]), double(c[4])}, h);
+        }
+
+        std::vector<T> c(1+2*P);
+        c[0] = 1;
+        for (auto k=1; k<=P; k++){
+            c[k] = T(num[k]);
+            c[P+k] = T(-den[k]);
+        }
+
+        std::vector<double> hm = _direct_form(std::vector<double>(c.begin(), c.begin()+1+P), std::vector<double>(c.begin()+1+P, c.end()), impulse);
+
+        double peak = 0, err = 0;
+        for (int k=0; k<len; k++){
+            peak = std::max(peak, std::abs(h[k]));
+            err = std::max(err, std::abs(hm[k] - h[k]));
+        }
+
+        if (err <= tol*peak) merged.insert(merged.end(), c.begin(), c.end());
+        else keep(i, m);
+    }
+
+    return merged;
+};
+
+#endif // header guard
@@ -0,0 +1,230 @@
+#ifndef HIGHER_ORDER_NODES_H
+#define HIGHER_ORDER_NODES_H 1
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "vectorclass.h"
+#include "data_block.h"
+#include "higher_order_cores_serial.h"
+
+/*
+    the stages of a section of order P in the multi-core graph, in the same places as InitAdder, NoStateZIC, RecurDoubV,
+    InterBlockRD and ICCForward of a second order section, e.g., merged sections. The sequencers and Buffer are shared. A block
+    carries the initial conditions [x_{-1} ... x_{-P}] and [y_{-1} ... y_{-P}] in xp_inits and yp_inits, and post_inits and
+    pre_inits keep 2P values per section in the order of IirCoreOrderP, [xi1 ... xiP yi1 ... yiP].
+ */
+
+// buffer inputs and attach the last P inputs before each block.
+template<typename V, int P> class InitAdderOrderP{
+
+    using T = decltype(std::declval<V>().extract(0));
+    static constexpr int M = V::size();
+
+    private:
+
+        std::array<T,P> _x;
+
+    public:
+
+        InitAdderOrderP(const T* xi){
+            for (auto k=0; k<P; k++) _x[k] = xi[k];
+        };
+
+        inline DataBlock<V> operator()(DataBlock<V> in){
+
+            // the initial conditions that are only known when the first block is sent
+            if (!in.pre_inits.empty())
+                for (auto k=0; k<P; k++) _x[k] = in.pre_inits[k];
+
+            for (auto k=0; k<P; k++){
+                in.xp_inits[k] = _x[k];
+                _x[k] = in.data[M-1-k][M-1];
+            }
+
+            return in;
+        };
+
+};
+
+// Stateless zero initial condition of a section of order P, each lane of the transposed block starts from zero output.
+template<typename V, int P> class NoStateZICOrderP{
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+    public:
+
+        NoStateZICOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in) {
+
+            if (in.last)
+                for (auto k=0; k<P; k++) in.post_inits.push_back(in.data[M-1-k][M-1]);
+
+            in.data = ZeroInitCondOrderP<V,P>::kernel(*_tab, in.data, in.xp_inits.data());
+
+            return in;
+        };
+
+};
+
+// stateless recursive doubling over the lanes of the last P vectors of a block, from zero output before the block.
+template<typename V, int P> class RecurDoubVOrderP{
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+    public:
+
+        RecurDoubVOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in){
+
+            std::array<V,P> z;
+            for (auto p=0; p<P; p++) z[p] = in.data[M-1-p];
+
+            _tab->doubling(_tab->phi, z);
+
+            for (auto p=0; p<P; p++) in.data[M-1-p] = z[p];
+
+            return in;
+        };
+
+};
+
+/*
+    the outputs before each of the buffered blocks, yp_inits. The last P outputs of the blocks from zero output before them are
+    gathered lane by lane, block j in lane j, and joined by recursive doubling over blocks with the powers of Phi^M. A buffer of
+    less than M blocks leaves the lanes after its blocks at zero.
+ */
+template <typename V, int P> class InterBlockRDOrderP: public tbb::flow::multifunction_node<std::vector<DataBlock<V>>, std::tuple<DataBlock<V>>> {
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+        // y_{-1}, ..., y_{-P} before the next buffer
+        std::array<T,P> _y;
+
+    public:
+
+        InterBlockRDOrderP(tbb::flow::graph& g, std::shared_ptr<const HigherOrderTable<V,P>> tab, const T* yi)
+        :tbb::flow::multifunction_node<std::vector<DataBlock<V>>, std::tuple<DataBlock<V>>>(
+            g, tbb::flow::serial,
+            [this](const std::vector<DataBlock<V>>& in, typename InterBlockRDOrderP::output_ports_type& ports){
+
+                const HigherOrderTable<V,P>& t = *this->_tab;
+
+                // the initial conditions that are only known when the first block is sent
+                if (!in[0].pre_inits.empty())
+                    for (auto k=0; k<P; k++) _y[k] = in[0].pre_inits[P+k];
+
+                std::array<V,P> z;
+                for (auto p=0; p<P; p++){
+
+                    std::array<T,M> ends{};
+                    for (size_t j=0; j<in.size(); j++) ends[j] = in[j].data[M-1-p][M-1];
+                    z[p].load(ends.data());
+                }
+
+                t.doubling(t.phi_blocks, z);
+                t.add_lanes(t.blocks_lanes, _y.data(), z);
+
+                std::array<T,P> before = _y;
+                for (auto q=0; q<P; q++) _y[q] = z[q][in.size()-1];
+
+                for (size_t j=0; j<in.size(); j++){
+
+                    DataBlock<V> data = in[j];
+
+                    for (auto q=0; q<P; q++) data.yp_inits[q] = (j == 0) ? before[q] : z[q][j-1];
+
+                    if (data.last)
+                        for (auto q=0; q<P; q++) data.post_inits.push_back(_y[q]);
+
+                    // the sections after this one take the rest of the initial conditions
+                    if (!data.pre_inits.empty())
+                        data.pre_inits.erase(data.pre_inits.begin(), data.pre_inits.begin() + 2*P);
+
+                    std::get<0>(ports).try_put(data);
+                }
+            }),
+            _tab(std::move(tab)) {
+
+                for (auto k=0; k<P; k++) _y[k] = yi[k];
+            }
+
+};
+
+// (stateless) correct the blocks of a section of order P from the outputs before the block.
+template<typename V, int P> class ICCForwardOrderP{
+
+    constexpr static int M = V::size();
+
+    private:
+
+        std::shared_ptr<const HigherOrderTable<V,P>> _tab;
+
+    public:
+
+        ICCForwardOrderP(std::shared_ptr<const HigherOrderTable<V,P>> tab): _tab(std::move(tab)) {};
+
+        inline DataBlock<V> operator()(DataBlock<V> in){
+
+            std::array<V,P> z;
+            for (auto p=0; p<P; p++) z[p] = in.data[M-1-p];
+
+            InitCondCorcOrderP<V,P>::correct(*_tab, in.data, z, in.yp_inits.data());
+
+            return in;
+        };
+
+};
+
+/*
+    the stages of a section of order P behind an interface that does not depend on P, so that sections of any order take their
+    places in the cascade of TBBIIRMultiCore. The stateful stages are made for each graph from the initial conditions,
+    [xi1 ... xiP] and [yi1 ... yiP].
+ */
+template<typename V> struct HigherOrderStages{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using Stage = std::function<DataBlock<V>(DataBlock<V>)>;
+    using InterBlock = tbb::flow::multifunction_node<std::vector<DataBlock<V>>, std::tuple<DataBlock<V>>>;
+
+    int order;
+
+    Stage zic, rd, forward;
+
+    std::function<Stage(const T*)> init_adder;
+    std::function<std::unique_ptr<InterBlock>(tbb::flow::graph&, const T*)> inter_block;
+};
+
+template<typename V, int P> inline std::shared_ptr<const HigherOrderStages<V>> make_higher_order_stages(std::shared_ptr<const HigherOrderTable<V,P>> tab) {
+
+    using T = typename HigherOrderStages<V>::T;
+
+    HigherOrderStages<V> s;
+
+    s.order = P;
+    s.zic = NoStateZICOrderP<V,P>{tab};
+    s.rd = RecurDoubVOrderP<V,P>{tab};
+    s.forward = ICCForwardOrderP<V,P>{tab};
+    s.init_adder = [](const T* xi){ return typename HigherOrderStages<V>::Stage(InitAdderOrderP<V,P>{xi}); };
+    s.inter_block = [tab](tbb::flow::graph& g, const T* yi){ return std::make_unique<InterBlockRDOrderP<V,P>>(g, tab, yi); };
+
+    return std::make_shared<const HigherOrderStages<V>>(std::move(s));
+};
+
+#endif // header guard
@@ -26,6 +26,13 @@ template<typename V> class InitAdder{
     
     inline DataBlock<V> operator()(DataBlock<V> in){
 
+        // the initial conditions that are only known when the first block is sent
+        if (!in.pre_inits.empty()){
+
+            _S.shift(in.pre_inits[1]);
+            _S.shift(in.pre_inits[0]);
+        }
+
         in.x_inits[0] = _S[-2];
         in.x_inits[1] = _S[-1];
 
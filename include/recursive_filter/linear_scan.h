@@ -0,0 +1,245 @@
+#ifndef LINEAR_SCAN_H
+#define LINEAR_SCAN_H 1
+
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <tbb/tbb.h>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "simd_vec.h"
+
+/*
+    Scan of the linear recurrences with coefficients given per sample,
+    first order:  y_n = a_n y_{n-1} + x_n
+    second order: y_n = a1_n y_{n-1} + a2_n y_{n-2} + x_n
+    Every range of samples is an affine map of the state before it. A tile of M*M samples is transposed so that each lane runs
+    M samples in a row, and the lanes are joined by recursive doubling over their maps. The tiles are joined by tbb::parallel_scan.
+ */
+template<typename V> class LinearScan{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+
+    // K: number of recursions in recursive doubling over M lanes, i.e., log2(M).
+    constexpr static int K = (M == 4) ? 2 : (M == 8) ? 3 : 4;
+
+    static_assert(M >= 4, "a tile is transposed by _permuteV, which needs at least 4 lanes");
+
+    public:
+
+        // the end of a range as affine map of the state before the range, y_end = A y_in + B.
+        struct Map{
+            T A = 1, B = 0;
+        };
+
+        // the last two values of a range as affine map of the two values before the range, [y_end y_end-1] = A [y_in1 y_in2] + B.
+        struct Map2{
+            T A11 = 1, A12 = 0, A21 = 0, A22 = 1, B1 = 0, B2 = 0;
+        };
+
+        // apply f and then s
+        static inline Map compose(const Map& s, const Map& f) {
+            return Map{s.A*f.A, s.A*f.B + s.B};
+        };
+
+        static inline Map2 compose(const Map2& s, const Map2& f) {
+            return Map2{s.A11*f.A11 + s.A12*f.A21, s.A11*f.A12 + s.A12*f.A22,
+                        s.A21*f.A11 + s.A22*f.A21, s.A21*f.A12 + s.A22*f.A22,
+                        s.A11*f.B1 + s.A12*f.B2 + s.B1, s.A21*f.B1 + s.A22*f.B2 + s.B2};
+        };
+
+    private:
+
+        static inline std::array<V,M> _load(const T* p) {
+
+            std::array<V,M> v;
+            for (auto n=0; n<M; n++) v[n].load(p + n*M);
+
+            return _permuteV(v);
+        };
+
+        static inline void _store(std::array<V,M> v, T* p) {
+
+            v = _permuteV(v);
+            for (auto n=0; n<M; n++) v[n].store(p + n*M);
+        };
+
+        // join the maps of lanes at stride S, the lane j becomes the map from the start of lane j-2S+1 to the end of lane j.
+        template<int S> static inline void _join(V& A, V& B) {
+
+            V As = lane_shift<S>(A, T(1));
+            V Bs = lane_shift<S>(B, T(0));
+
+            B = mul_add(A, Bs, B);
+            A = A*As;
+        };
+
+        template<int S> static inline void _join(V& A11, V& A12, V& A21, V& A22, V& B1, V& B2) {
+
+            V A11s = lane_shift<S>(A11, T(1)), A12s = lane_shift<S>(A12, T(0));
+            V A21s = lane_shift<S>(A21, T(0)), A22s = lane_shift<S>(A22, T(1));
+            V B1s = lane_shift<S>(B1, T(0)), B2s = lane_shift<S>(B2, T(0));
+
+            B1 = mul_add(A11, B1s, mul_add(A12, B2s, B1));
+            B2 = mul_add(A21, B1s, mul_add(A22, B2s, B2));
+
+            V a11 = mul_add(A11, A11s, A12*A21s);
+            V a12 = mul_add(A11, A12s, A12*A22s);
+            V a21 = mul_add(A21, A11s, A22*A21s);
+            V a22 = mul_add(A21, A12s, A22*A22s);
+
+            A11 = a11; A12 = a12; A21 = a21; A22 = a22;
+        };
+
+    public:
+
+        // the map of one tile of first order, and the outputs from the state y_in before the tile if Final.
+        template<bool Final> static inline Map tile(const T* a, const T* x, T* y, const T y_in) {
+
+            std::array<V,M> at = _load(a), w = _load(x), P;
+
+            // each lane separately: zero state output w and the product of coefficients P
+            P[0] = at[0];
+            for (auto k=1; k<M; k++) {
+                w[k] = mul_add(at[k], w[k-1], w[k]);
+                P[k] = at[k]*P[k-1];
+            }
+
+            // join the lanes, the lane j becomes the map from the start of the tile to the end of lane j
+            V A = P[M-1], B = w[M-1];
+            [&]<int... k>(std::integer_sequence<int, k...>) {
+                (_join<(1 << k)>(A, B), ...);
+            }(std::make_integer_sequence<int, K>{});
+
+            if constexpr (Final) {
+
+                // the state before each lane
+                V s = lane_shift<1>(mul_add(A, y_in, B), y_in);
+
+                for (auto k=0; k<M; k++) w[k] = mul_add(P[k], s, w[k]);
+
+                _store(w, y);
+            }
+
+            return Map{A[M-1], B[M-1]};
+        };
+
+        // the map of one tile of second order, and the outputs from the states [y_in1 y_in2] before the tile if Final.
+        template<bool Final> static inline Map2 tile(const T* a1, const T* a2, const T* x, T* y, const T y_in1, const T y_in2) {
+
+            std::array<V,M> at1 = _load(a1), at2 = _load(a2), w = _load(x), g1, g2;
+
+            // each lane separately: zero state output w and the responses g1, g2 to the two states before the lane
+            g1[0] = at1[0];
+            g2[0] = at2[0];
+            g1[1] = mul_add(at1[1], at1[0], at2[1]);
+            g2[1] = at1[1]*at2[0];
+            w[1] = mul_add(at1[1], w[0], w[1]);
+
+            for (auto k=2; k<M; k++) {
+                w[k] = mul_add(at1[k], w[k-1], mul_add(at2[k], w[k-2], w[k]));
+                g1[k] = mul_add(at1[k], g1[k-1], at2[k]*g1[k-2]);
+                g2[k] = mul_add(at1[k], g2[k-1], at2[k]*g2[k-2]);
+            }
+
+            // join the lanes, the lane j becomes the map from the start of the tile to the end of lane j
+            V A11 = g1[M-1], A12 = g2[M-1], A21 = g1[M-2], A22 = g2[M-2], B1 = w[M-1], B2 = w[M-2];
+            [&]<int... k>(std::integer_sequence<int, k...>) {
+                (_join<(1 << k)>(A11, A12, A21, A22, B1, B2), ...);
+            }(std::make_integer_sequence<int, K>{});
+
+            if constexpr (Final) {
+
+                // the states before each lane
+                V s1 = lane_shift<1>(mul_add(A11, y_in1, mul_add(A12, y_in2, B1)), y_in1);
+                V s2 = lane_shift<1>(mul_add(A21, y_in1, mul_add(A22, y_in2, B2)), y_in2);
+
+                for (auto k=0; k<M; k++) w[k] = mul_add(g1[k], s1, mul_add(g2[k], s2, w[k]));
+
+                _store(w, y);
+            }
+
+            return Map2{A11[M-1], A12[M-1], A21[M-1], A22[M-1], B1[M-1], B2[M-1]};
+        };
+
+        // scan len samples from the state y_in, the outputs may overwrite x. Returns the last output.
+        static inline T scan(const T* a, const T* x, T* y, const size_t len, const T y_in = 0, const size_t grain = 64) {
+
+            size_t tiles = len/L;
+
+            Map m = tbb::parallel_scan(tbb::blocked_range<size_t>(0, tiles, grain), Map{},
+                [&](const tbb::blocked_range<size_t>& r, Map m, bool is_final) -> Map {
+
+                    for (size_t t=r.begin(); t<r.end(); t++) {
+
+                        if (is_final)
+                            m = compose(tile<true>(a + t*L, x + t*L, y + t*L, m.A*y_in + m.B), m);
+                        else
+                            m = compose(tile<false>(a + t*L, x + t*L, nullptr, T(0)), m);
+                    }
+
+                    return m;
+                },
+                [](const Map& left, const Map& right) { return compose(right, left); });
+
+            // the rest samples one by one
+            T s = m.A*y_in + m.B;
+            for (size_t n=tiles*L; n<len; n++) {
+                s = a[n]*s + x[n];
+                y[n] = s;
+            }
+
+            return s;
+        };
+
+        // scan len samples of second order from the states y_in1 = y_{-1}, y_in2 = y_{-2}. Returns the last two outputs.
+        static inline std::array<T,2> scan(const T* a1, const T* a2, const T* x, T* y, const size_t len, const T y_in1 = 0, const T y_in2 = 0, const size_t grain = 64) {
+
+            size_t tiles = len/L;
+
+            Map2 m = tbb::parallel_scan(tbb::blocked_range<size_t>(0, tiles, grain), Map2{},
+                [&](const tbb::blocked_range<size_t>& r, Map2 m, bool is_final) -> Map2 {
+
+                    for (size_t t=r.begin(); t<r.end(); t++) {
+
+                        size_t o = t*L;
+
+                        if (is_final)
+                            m = compose(tile<true>(a1 + o, a2 + o, x + o, y + o,
+                                                   m.A11*y_in1 + m.A12*y_in2 + m.B1, m.A21*y_in1 + m.A22*y_in2 + m.B2), m);
+                        else
+                            m = compose(tile<false>(a1 + o, a2 + o, x + o, nullptr, T(0), T(0)), m);
+                    }
+
+                    return m;
+                },
+                [](const Map2& left, const Map2& right) { return compose(right, left); });
+
+            // the rest samples one by one
+            T s1 = m.A11*y_in1 + m.A12*y_in2 + m.B1;
+            T s2 = m.A21*y_in1 + m.A22*y_in2 + m.B2;
+            for (size_t n=tiles*L; n<len; n++) {
+                T s = a1[n]*s1 + a2[n]*s2 + x[n];
+                s2 = s1;
+                s1 = s;
+                y[n] = s;
+            }
+
+            return {s1, s2};
+        };
+
+};
+
+// real function to user: y_n = a_n y_{n-1} + x_n over len samples from y_in, e.g., decaying accumulators and discounted returns.
+template<typename T> inline T linear_scan(const T* a, const T* x, T* y, const size_t len, const T y_in = 0) {
+    return LinearScan<SimdVec<T>>::scan(a, x, y, len, y_in);
+}
+
+// real function to user: y_n = a1_n y_{n-1} + a2_n y_{n-2} + x_n over len samples from y_{-1} = y_in1, y_{-2} = y_in2.
+template<typename T> inline std::array<T,2> linear_scan(const T* a1, const T* a2, const T* x, T* y, const size_t len, const T y_in1 = 0, const T y_in2 = 0) {
+    return LinearScan<SimdVec<T>>::scan(a1, a2, x, y, len, y_in1, y_in2);
+}
+
+#endif // header guard
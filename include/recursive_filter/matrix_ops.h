@@ -0,0 +1,78 @@
+#ifndef MATRIX_OPS_H
+#define MATRIX_OPS_H 1
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <utility>
+
+// operations on polynomials and small dense matrices, used when the filters are designed, not per sample.
+
+// product of two polynomials in z^{-1}
+inline std::vector<double> _poly_mul(const std::vector<double>& p, const std::vector<double>& q) {
+
+    std::vector<double> r(p.size() + q.size() - 1, 0);
+    for (size_t i=0; i<p.size(); i++)
+        for (size_t j=0; j<q.size(); j++)
+            r[i+j] += p[i]*q[j];
+
+    return r;
+};
+
+// X Y of S by S matrices in row major
+template<typename T> inline std::vector<T> _mat_mul(const std::vector<T>& X, const std::vector<T>& Y, const int S) {
+
+    std::vector<T> Z(S*S, 0);
+    for (auto p=0; p<S; p++)
+        for (auto r=0; r<S; r++)
+            for (auto q=0; q<S; q++)
+                Z[p*S+q] += X[p*S+r]*Y[r*S+q];
+
+    return Z;
+};
+
+// X^k of an S by S matrix in row major by repeated squaring, in double precision
+inline std::vector<double> _mat_power(std::vector<double> X, size_t k, const int S) {
+
+    std::vector<double> P(S*S, 0.0);
+    for (auto p=0; p<S; p++) P[p*S+p] = 1;
+
+    for (; k > 0; k >>= 1){
+
+        if (k & 1) P = _mat_mul(X, P, S);
+        X = _mat_mul(X, X, S);
+    }
+
+    return P;
+};
+
+// solve the P equations of the augmented matrix S (P rows of P+1) by gaussian elimination with partial pivoting, in place.
+inline std::vector<double> _solve(std::vector<std::vector<double>> S) {
+
+    const size_t P = S.size();
+
+    for (size_t c=0; c<P; c++){
+
+        size_t p = c;
+        for (size_t r=c+1; r<P; r++)
+            if (std::abs(S[r][c]) > std::abs(S[p][c])) p = r;
+
+        std::swap(S[c], S[p]);
+        assert(S[c][c] != 0);
+
+        for (size_t r=0; r<P; r++){
+
+            if (r == c) continue;
+
+            double f = S[r][c]/S[c][c];
+            for (size_t j=c; j<=P; j++) S[r][j] -= f*S[c][j];
+        }
+    }
+
+    std::vector<double> x(P);
+    for (size_t r=0; r<P; r++) x[r] = S[r][P]/S[r][r];
+
+    return x;
+};
+
+#endif // header guard
@@ -0,0 +1,276 @@
+#ifndef MULTI_CHANNEL_FILTER_H
+#define MULTI_CHANNEL_FILTER_H 1
+
+#include <array>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <tbb/tbb.h>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "simd_vec.h"
+
+/*
+    cascaded second order sections in every lane of a SIMD vector, each lane is an independent signal with its own state. C is
+    the storage of the coefficients b1 b2 a1 a2 of a section: scalars shared by all lanes, or vectors with the coefficients of
+    every lane in its own lane.
+ */
+template<typename V, typename C = std::array<decltype(std::declval<V>().extract(0)),4>> class LaneCascade{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+
+    public:
+
+        // state of one section for the lanes: x_{-1}, x_{-2}, y_{-1}, y_{-2}
+        using State = std::array<V,4>;
+
+    private:
+
+        // coefficients of each section: b1 b2 a1 a2
+        std::vector<C> _coefs;
+
+    public:
+
+        LaneCascade(){};
+
+        // n sections of contiguous coefficients [b0 b1 b2 a1 a2] shared by all lanes
+        LaneCascade(const T* coefs,const int n){
+
+            for (int i=0;i<n;i++)
+                _coefs.push_back({coefs[5*i+1],coefs[5*i+2],coefs[5*i+3],coefs[5*i+4]});
+        }
+
+        // n sections of coefficients per lane, zeros until set_lane_coefs
+        explicit LaneCascade(const int n): _coefs(n){
+
+            static_assert(std::is_same<C,State>::value, "only the coefficients per lane are set by lane");
+            for (auto& c: _coefs) c.fill(V(0));
+        }
+
+        // the cascade over one vector of samples, one sample per lane, s: the state of each section.
+        inline V step(V x, State* s) const {
+
+            for (size_t i=0;i<_coefs.size();i++){
+
+                const C& c = _coefs[i];
+
+                V y = mul_add(s[i][1], c[1], x);
+                y = mul_add(s[i][0], c[0], y);
+                y = mul_add(s[i][3], c[3], y);
+                y = mul_add(s[i][2], c[2], y);
+
+                s[i][1] = s[i][0];
+                s[i][0] = x;
+                s[i][3] = s[i][2];
+                s[i][2] = y;
+
+                x = y;
+            }
+
+            return x;
+        }
+
+        // set the coefficients [b1 b2 a1 a2] of every section of one lane, zeros if coefs is null.
+        inline void set_lane_coefs(const int lane,const T* coefs){
+
+            static_assert(std::is_same<C,State>::value, "only the coefficients per lane are set by lane");
+
+            for (size_t i=0;i<_coefs.size();i++)
+                for (auto q=0; q<4; q++)
+                    _coefs[i][q].insert(lane, coefs ? coefs[4*i+q] : T(0));
+        }
+
+        // set the initial conditions [xi1 xi2 yi1 yi2] of every section of one lane, zeros if inits is null.
+        inline void set_lane(State* s,const int lane,const T* inits) const {
+
+            for (size_t i=0;i<_coefs.size();i++)
+                for (auto q=0; q<4; q++)
+                    s[i][q].insert(lane, inits ? inits[4*i+q] : T(0));
+        }
+
+        // the current initial conditions [xi1 xi2 yi1 yi2] of every section of one lane.
+        inline void get_lane(const State* s,const int lane,T* inits) const {
+
+            for (size_t i=0;i<_coefs.size();i++)
+                for (auto q=0; q<4; q++)
+                    inits[4*i+q] = s[i][q][lane];
+        }
+
+        /*
+            run the lanes over spans of samples of different lengths, each lane takes its next span as soon as its span ends.
+            refill(j, in, out, len) sets the next span of lane j and returns false if there is none, it is where a lane keeps
+            the state of a signal that ends and sets the state of the next one. The lanes move by M samples (one transposed
+            matrix) while every span in the lanes has M samples left, otherwise by one sample. The lanes without a span filter
+            zeros that are not stored.
+         */
+        template<typename Refill> inline void run(State* s, Refill refill) const {
+
+            std::array<const T*,M> in;
+            std::array<T*,M> out;
+            std::array<size_t,M> len;
+            std::array<bool,M> live;
+
+            for (auto j=0; j<M; j++) live[j] = refill(j, in[j], out[j], len[j]);
+
+            std::array<V,M> tile;
+            T buf[M];
+
+            while (std::any_of(live.begin(), live.end(), [](bool x){ return x; })){
+
+                // samples that every span in the lanes has left
+                size_t d = M;
+                for (auto j=0; j<M; j++)
+                    if (live[j]) d = std::min(d, len[j]);
+
+                if (d == M){
+
+                    for (auto j=0; j<M; j++){
+                        if (live[j]) tile[j].load(in[j]);
+                        else tile[j] = V(0);
+                    }
+
+                    tile = _permuteV(tile);
+                    for (auto k=0; k<M; k++) tile[k] = step(tile[k], s);
+                    tile = _permuteV(tile);
+
+                    for (auto j=0; j<M; j++)
+                        if (live[j]) tile[j].store(out[j]);
+
+                } else {
+
+                    for (size_t k=0; k<d; k++){
+
+                        for (auto j=0; j<M; j++) buf[j] = live[j] ? in[j][k] : T(0);
+
+                        V y;
+                        y.load(buf);
+                        y = step(y, s);
+                        y.store(buf);
+
+                        for (auto j=0; j<M; j++)
+                            if (live[j]) out[j][k] = buf[j];
+                    }
+                }
+
+                for (auto j=0; j<M; j++){
+
+                    if (!live[j]) continue;
+
+                    in[j] += d;
+                    out[j] += d;
+                    len[j] -= d;
+
+                    if (len[j] == 0) live[j] = refill(j, in[j], out[j], len[j]);
+                }
+            }
+        }
+
+        inline int size() const { return _coefs.size(); }
+
+};
+
+/*
+    real function to user: the same cascaded second order filter over many independent channels. One channel is one lane of
+    the SIMD vector, so every lane runs the recursive equation y_n = x_n + b_1x_{n-1} + b_2x_{n-2} + a_1y_{n-1} + a_2y_{n-2}
+    on its own and neither recursive doubling nor block filtering is needed. The groups of M channels run on different cores.
+ */
+template<typename T> class MultiChannelFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+
+    using State = typename LaneCascade<V>::State;
+
+    private:
+
+        // number of cascaded sos and of channels
+        int _n, _channels;
+
+        // the cascade in every lane
+        LaneCascade<V> _sos;
+
+        // state of each section of each group of channels, [group*n + section]
+        std::vector<State> _state;
+
+        // filter len samples of the group of channels starting at channel c0, the samples of channel c start at in[c*stride].
+        inline void _group(const T* in, T* out, const size_t len, const size_t stride, const int c0){
+
+            State* s = &_state[(c0/M)*_n];
+            int m = std::min(M, _channels - c0);
+
+            std::array<V,M> tile;
+            size_t k = 0;
+
+            // M samples of M channels: load the rows of channels and transpose, so one vector holds one sample of every channel
+            if (m == M){
+                for (; k+M <= len; k += M){
+
+                    for (auto c=0; c<M; c++) tile[c].load(in + (c0+c)*stride + k);
+
+                    tile = _permuteV(tile);
+                    for (auto j=0; j<M; j++) tile[j] = _sos.step(tile[j], s);
+                    tile = _permuteV(tile);
+
+                    for (auto c=0; c<M; c++) tile[c].store(out + (c0+c)*stride + k);
+                }
+            }
+
+            // the rest samples, or a group of less than M channels, one sample of every channel at a time
+            T buf[M];
+            for (; k<len; k++){
+
+                for (auto c=0; c<M; c++) buf[c] = (c < m) ? in[(c0+c)*stride + k] : T(0);
+
+                V y;
+                y.load(buf);
+                y = _sos.step(y, s);
+                y.store(buf);
+
+                for (auto c=0; c<m; c++) out[(c0+c)*stride + k] = buf[c];
+            }
+        }
+
+    public:
+
+        // n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2], shared by all channels.
+        MultiChannelFilter(const T* coefs,const T* inits,const int n,const int channels): _n(n),_channels(channels),_sos(coefs,n){
+
+            _state.resize(((channels + M - 1)/M)*n);
+            for (int c=0;c<channels;c++)
+                set_inits(c,inits);
+        }
+
+        template<int K> MultiChannelFilter(const T (&coefs)[K][5],const T (&inits)[K][4],const int channels): MultiChannelFilter(&coefs[0][0],&inits[0][0],K,channels){}
+
+        // set the initial conditions [xi1 xi2 yi1 yi2] of every section of one channel.
+        inline void set_inits(const int channel,const T* inits){
+            _sos.set_lane(&_state[(channel/M)*_n], channel%M, inits);
+        }
+
+        // the current initial conditions [xi1 xi2 yi1 yi2] of every section of one channel.
+        inline void get_inits(const int channel,T* inits) const {
+            _sos.get_lane(&_state[(channel/M)*_n], channel%M, inits);
+        }
+
+        /*
+            filter len samples of every channel, the samples of channel c are in[c*stride], ..., in[c*stride + len-1] (stride = len
+            if 0), and the outputs are written in the same layout. The state of every channel is kept for the next call.
+         */
+        inline void operator()(const T* in,T* out,const size_t len,size_t stride=0){
+
+            if (stride == 0) stride = len;
+
+            tbb::parallel_for(0, (_channels + M - 1)/M, [&](int g){
+                _group(in, out, len, stride, g*M);
+            });
+        }
+
+        inline int channels() const { return _channels; }
+
+};
+
+#endif // header guard
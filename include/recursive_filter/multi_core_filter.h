@@ -2,40 +2,198 @@
 #define MULTI_CORE_FILTER_H 1
 
 #include "tbb_iir_multi_core.h"
+#include "runtime_series.h"
+#include "higher_order_nodes.h"
+#include "zero_gap.h"
+#include "simd_vec.h"
 #include <vector>
 #include <tuple>
+#include <deque>
+#include <mutex>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+// single-core filter: the cascade unrolled at compile time if N is known, otherwise the cascade dispatched at runtime.
+template<typename T,typename V,int N> struct SeriesType{
+    using type = decltype(series_from_tables<T,V,N>(std::declval<const std::vector<std::shared_ptr<const SectionTable<V>>>&>(), std::declval<const T*>()));
+};
+
+template<typename T,typename V> struct SeriesType<T,V,Dynamic>{
+    using type = RuntimeSeries<V>;
+};
 
 // real function to user: use the cascaded second order filter to process a trunk of data.
-template<typename T,int N> class MultiCoreFilter{ 
+// N denotes the number of cascaded sos, or Dynamic if the filter design is only known at runtime.
+template<typename T,int N=Dynamic> class MultiCoreFilter{ 
     
     // select the vector length and type based on the requested instruction set and the type T
-    #if INSTRSET >= 9  // AVX512
-        using V = typename std::conditional<std::is_same<T, float>::value, Vec16f, Vec8d>::type;
-    #elif INSTRSET >= 7  // AVX2
-        using V = typename std::conditional<std::is_same<T, float>::value, Vec8f, Vec4d>::type;
-    #else // SSE
-        using V = typename std::conditional<std::is_same<T, float>::value, Vec4f, Vec2d>::type;
-    #endif
+    using V = SimdVec<T>;
 
     constexpr static int M = V::size();
 
+    using Tables_t = std::vector<std::shared_ptr<const SectionTable<V>>>;
+
     private:
 
+        // number of cascaded sos
+        int _n;
+
+        // pre-computed tables of sections, computed once and shared by the multi-core and single-core filters.
+        Tables_t _tabs;
+
+        // the stages of the merged sections in front of the sos, see the constructor of merged sections.
+        std::vector<std::shared_ptr<const HigherOrderStages<V>>> _stages;
+
         // multi-core filter
         TBBIIRMultiCore<V, N> _MC;
 
-        // single-core filter
-        using Series_t = decltype(series_from_coeffs<T,V>(std::declval<const T (&)[N][5]>(), std::declval<const T (&)[N][4]>())); 
+        // single-core filter, the cores of the merged sections in front of the sos
+        using Series_t = typename SeriesType<T,V,N>::type;
         Series_t _S;
+        std::vector<AnyOrderCore<V>> _merged;
+
+        // position of the next sample in the stream
+        size_t _pos = 0;
+
+        // scheduled swaps of coefficients: the sample boundary and the tables from there on
+        std::deque<std::pair<size_t,Tables_t>> _swaps;
+        std::unique_ptr<std::mutex> _mutex = std::make_unique<std::mutex>();
+
+        static Tables_t make_tables(const T* coefs, const int n){
+
+            Tables_t tabs;
+            for (int i=0;i<n;i++)
+                tabs.push_back(make_section_table<V>(coefs + 5*i));
+
+            return tabs;
+        }
+
+        static Series_t make_series(const Tables_t& tabs, const T* inits){
+
+            if constexpr (N == Dynamic)
+                return RuntimeSeries<V>(tabs, inits);
+            else
+                return series_from_tables<T,V,N>(tabs, inits);
+        }
 
     public:
 
-        MultiCoreFilter(const T (&coefs)[N][5],const T (&inits)[N][4]): _MC{coefs,inits},_S(series_from_coeffs<T,V>(coefs, inits)){}
+        template<int K> MultiCoreFilter(const T (&coefs)[K][5],const T (&inits)[K][4]): MultiCoreFilter(&coefs[0][0],&inits[0][0],K){
+
+            static_assert(N == Dynamic || K == N, "the number of sections of the arrays is not the one of the filter");
+        }
+
+        // Overloaded constructor, n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2].
+        MultiCoreFilter(const T* coefs,const T* inits,const int n): _n(n),_tabs(make_tables(coefs,n)),_MC{_tabs,inits},_S(make_series(_tabs,inits)){
+
+            assert(N == Dynamic || n == N);
+        }
+
+        /*
+            Overloaded constructor, n sections of contiguous coefficients [b0 b1 b2 a1 a2] of which every P/2 consecutive ones are
+            merged into one section of order P where merge_sections finds the merged one accurate enough, which halves the
+            stages of the graph for P = 4. The merged sections run first and the filter starts from rest; get_inits gives
+            [xi1 ... xiP yi1 ... yiP] of each merged section followed by [xi1 xi2 yi1 yi2] of each sos. Swaps of coefficients,
+            advance_zero and filtfilt take second order sections only.
+         */
+        template<int P> MultiCoreFilter(const T* coefs,const int n,std::integral_constant<int,P>): MultiCoreFilter(_merge<P>(coefs,n)){}
+
+    private:
+
+        template<int P> using Merged_t = std::pair<std::vector<std::shared_ptr<const HigherOrderTable<V,P>>>,std::vector<T>>;
+
+        // the tables of the merged sections and the coefficients of the sos that stay second order
+        template<int P> static Merged_t<P> _merge(const T* coefs,const int n){
+
+            static_assert(N == Dynamic, "the number of sections that stay second order is only known at runtime");
+
+            Merged_t<P> sections;
+            auto merged = merge_sections<P>(coefs,n,&sections.second);
+
+            for (size_t k=0;k<merged.size();k+=1+2*P)
+                sections.first.push_back(make_higher_order_table<V,P>(&merged[k]));
+
+            return sections;
+        }
+
+        template<int P> static std::vector<std::shared_ptr<const HigherOrderStages<V>>> _make_stages(const Merged_t<P>& sections){
+
+            std::vector<std::shared_ptr<const HigherOrderStages<V>>> stages;
+            for (auto& t: sections.first)
+                stages.push_back(make_higher_order_stages<V,P>(t));
+
+            return stages;
+        }
+
+        template<int P> MultiCoreFilter(const Merged_t<P>& sections)
+        :_n(sections.second.size()/5),_tabs(make_tables(sections.second.data(),_n)),_stages(_make_stages(sections)),
+         _MC{_stages,_tabs,std::vector<T>(4*_n+2*P*_stages.size(),0).data()},_S(make_series(_tabs,std::vector<T>(4*_n,0).data())){
+
+            const std::vector<T> zeros(2*P,0);
+            for (auto& t: sections.first)
+                _merged.push_back(any_order_core<V,P>(t,zeros.data()));
+        }
+
+        // the number of initial conditions of the cascade, 2P per merged section and 4 per sos
+        inline size_t _width() const {
+
+            size_t w = 4*_n;
+            for (auto& c: _merged) w += 2*c.order;
+
+            return w;
+        }
+
+        // the state of the single-core filter that the multi-core filter continues from, in the order of get_inits.
+        inline std::vector<T> _inits(){
+
+            std::vector<T> inits(_width());
+            T* p = inits.data();
+
+            for (auto& c: _merged){
+                c.get_inits(p);
+                p += 2*c.order;
+            }
+
+            _S.get_inits(p);
+
+            return inits;
+        }
+
+        // refresh the initial conditions of each section in the single-core filter from the post_inits of the multi-core filter
+        inline void _inits_refresh(const std::vector<T>& post_inits){
+
+            const T* p = post_inits.data();
+
+            for (auto& c: _merged){
+                c.inits_refresh(p);
+                p += 2*c.order;
+            }
+
+            _S.inits_refresh(p);
+        }
+
+        inline T _scalar(T x){
+
+            for (auto& c: _merged) x = c.scalar(x);
+            return _S.series_scalar(x);
+        }
+
+        inline V _option1(V x){
+
+            for (auto& c: _merged) x = c.option1(x);
+            return _S.series_option1(x);
+        }
     
-    template<typename InputIt,typename OutputIt> inline OutputIt operator()(InputIt first,InputIt last,OutputIt d_first){
+    // filter a range of samples with the current coefficients.
+    template<typename InputIt,typename OutputIt> inline OutputIt _filter(InputIt first,InputIt last,OutputIt d_first){
 
         // if the number of input samples is the multiple of M^2, then go multi-core multi-block filtering.
-        if (first <= last - M*M){
+        if (std::distance(first,last) >= M*M){
+
+            // the multi-core filter continues from the state that the single-core filter has reached
+            _MC.set_inits(_inits().data());
 
             std::vector<T> input;
             std::pair<std::vector<T>,std::vector<T>> output;
@@ -46,19 +204,8 @@ template<typename T,int N> class MultiCoreFilter{
 
             std::copy(output.first.begin(), output.first.end(), d_first);
 
-            T inits[N][4];
-            for (int i=0;i<N;i++)
-                for (int m=0;m<4;m++)
-                    inits[i][m] = output.second[4*i+m];
-                
-            auto& series = _S.get_series_state();
-
-            // Apply the inits_refresh function to each element in the tuple
-            for_each_in_tuple(series, [&](auto& sos) {
-                static int i = 0; // Static to retain value between calls
-                sos.inits_refresh(inits[i]);
-                ++i;
-            });
+            // refresh the initial conditions of each section in the single-core filter
+            _inits_refresh(output.second);
 
             first += d;
             d_first += d;
@@ -67,11 +214,11 @@ template<typename T,int N> class MultiCoreFilter{
 
         // if the number of input samples is less than M^2 but greater than M.
         V x, y;
-        while (first <= last - M){
+        while (std::distance(first,last) >= M){
 
             x.load(&*first);  
             
-            y = _S.series_option1(x);
+            y = _option1(x);
 
             y.store(&*d_first);
 
@@ -81,9 +228,9 @@ template<typename T,int N> class MultiCoreFilter{
         }
 
         // if the number of input samples is less than M then do scalar operation.
-        while (first <= last - 1){
+        while (first != last){
             
-            *d_first = _S.series_scalar(*first);
+            *d_first = _scalar(*first);
 
             first += 1;
             d_first += 1;
@@ -92,12 +239,365 @@ template<typename T,int N> class MultiCoreFilter{
 
         return d_first;
     }
+
+    // filter a range of samples with the current coefficients and keep the samples at the positions of the stream that are multiples of D.
+    template<typename InputIt,typename OutputIt> inline OutputIt _decimate(InputIt first,InputIt last,OutputIt d_first,const size_t D){
+
+        // the position of the first sample in the stream
+        size_t pos = _pos;
+
+        if (std::distance(first,last) >= M*M){
+
+            // the multi-core filter continues from the state that the single-core filter has reached
+            _MC.set_inits(_inits().data());
+
+            auto d = std::distance(first,last)/(M*M)*(M*M);
+            std::vector<T> input(first,first+d);
+
+            auto output = _MC.decimate(input, D, (D - pos%D)%D);
+
+            d_first = std::copy(output.first.begin(), output.first.end(), d_first);
+
+            // refresh the initial conditions of each section in the single-core filter
+            _inits_refresh(output.second);
+
+            first += d;
+            pos += d;
+        }
+
+        // only the kept lanes of a block are stored
+        V x, y;
+        while (std::distance(first,last) >= M){
+
+            x.load(&*first);
+
+            y = _option1(x);
+
+            for (size_t j = (D - pos%D)%D; j < size_t(M); j += D){
+                *d_first = y[j];
+                d_first += 1;
+            }
+
+            first += M;
+            pos += M;
+        }
+
+        while (first != last){
+
+            T r = _scalar(*first);
+
+            if (pos%D == 0){
+                *d_first = r;
+                d_first += 1;
+            }
+
+            first += 1;
+            pos += 1;
+        }
+
+        return d_first;
+    }
+
+    // filter the range of samples zero-stuffed by U with the current coefficients, U*len output samples.
+    template<typename InputIt,typename OutputIt> inline OutputIt _interpolate(InputIt first,InputIt last,OutputIt d_first,const size_t U){
+
+        // the multi-core filter takes the samples whose stuffed length is a multiple of M^2
+        const size_t q = M*M/std::gcd<size_t>(M*M, U);
+        auto d = std::distance(first,last)/q*q;
+
+        if (d > 0){
+
+            // the multi-core filter continues from the state that the single-core filter has reached
+            _MC.set_inits(_inits().data());
+
+            std::vector<T> input(first,first+d);
+
+            auto output = _MC.interpolate(input, U);
+
+            d_first = std::copy(output.first.begin(), output.first.end(), d_first);
+
+            // refresh the initial conditions of each section in the single-core filter
+            _inits_refresh(output.second);
+
+            first += d;
+        }
+
+        // the rest is stuffed explicitly, it is shorter than q*U samples
+        std::vector<T> stuffed(std::distance(first,last)*U, T(0));
+        for (size_t k = 0; first != last; first++, k += U) stuffed[k] = *first;
+
+        return _filter(stuffed.begin(), stuffed.end(), d_first);
+    }
+
+        // take the swaps whose boundary has been reached, only the tables are exchanged here.
+        inline void _apply_swaps(){
+
+            std::lock_guard<std::mutex> lock(*_mutex);
+
+            while (!_swaps.empty() && _swaps.front().first <= _pos){
+
+                _tabs = std::move(_swaps.front().second);
+                _swaps.pop_front();
+
+                _MC.set_tables(_tabs);
+                _S.tables_refresh(_tabs);
+            }
+        }
+
+        // the next boundary of scheduled swaps, or the maximum if there is none.
+        inline size_t _next_swap(){
+
+            std::lock_guard<std::mutex> lock(*_mutex);
+            return _swaps.empty() ? std::numeric_limits<size_t>::max() : _swaps.front().first;
+        }
+
+    public:
+
+    template<typename InputIt,typename OutputIt> inline OutputIt operator()(InputIt first,InputIt last,OutputIt d_first){
+
+        _apply_swaps();
+
+        // split the samples at the boundaries where new coefficients take effect.
+        while (first != last){
+
+            size_t n = std::distance(first,last);
+            size_t d = std::min(n, _next_swap() - _pos);
+
+            d_first = _filter(first,first+d,d_first);
+
+            first += d;
+            _pos += d;
+
+            _apply_swaps();
+        }
+
+        return d_first;
+    }
+
+    /*
+        fused decimation by D: filter the samples and write only the ones whose position in the stream is a multiple of D, i.e.,
+        the same samples as every D-th output of operator() from construction, so that calls of any length can follow each other.
+        Returns the end of the written samples.
+     */
+    template<typename InputIt,typename OutputIt> inline OutputIt decimate(InputIt first,InputIt last,OutputIt d_first,const size_t D){
+
+        assert(D > 0);
+
+        _apply_swaps();
+
+        while (first != last){
+
+            size_t n = std::distance(first,last);
+            size_t d = std::min(n, _next_swap() - _pos);
+
+            d_first = _decimate(first,first+d,d_first,D);
+
+            first += d;
+            _pos += d;
+
+            _apply_swaps();
+        }
+
+        return d_first;
+    }
+
+    /*
+        interpolation by U: filter the samples zero-stuffed by U, i.e., U-1 zeros after each sample, without building the stuffed
+        signal, so U*len samples are written and the stream advances by U*len positions. The output is the same as the one of
+        operator() over the explicitly stuffed samples, including the scheduled swaps of coefficients.
+     */
+    template<typename InputIt,typename OutputIt> inline OutputIt interpolate(InputIt first,InputIt last,OutputIt d_first,const size_t U){
+
+        assert(U > 0);
+
+        _apply_swaps();
+
+        while (first != last){
+
+            size_t n = std::distance(first,last)*U;
+            size_t d = std::min(n, _next_swap() - _pos)/U;
+
+            if (d > 0){
+
+                d_first = _interpolate(first,first+d,d_first,U);
+
+                first += d;
+                _pos += d*U;
+
+                _apply_swaps();
+
+            } else {
+
+                // a swap falls within the zeros of this sample, which are stuffed explicitly
+                std::vector<T> stuffed(U, T(0));
+                stuffed[0] = *first;
+
+                d_first = (*this)(stuffed.begin(), stuffed.end(), d_first);
+
+                first += 1;
+            }
+        }
+
+        return d_first;
+    }
+
+    /*
+        advance the stream over a gap of K samples of zero input without filtering them, e.g., a gap of telemetry. The state of
+        every section jumps by the powers of the transition matrix of the cascade, see advance_zero, and the scheduled swaps of
+        coefficients within the gap take effect at their boundaries. No output is written.
+     */
+    inline void advance_zero(size_t K){
+
+        assert(_merged.empty());
+
+        _apply_swaps();
+
+        std::vector<T> inits(4*_n), post(4*_n);
+
+        while (K > 0){
+
+            size_t d = std::min(K, _next_swap() - _pos);
+
+            _S.get_inits(inits.data());
+            ::advance_zero(_tabs, inits.data(), d);
+
+            // the single-core filter takes the order of post_inits, [xi2 xi1 yi2 yi1]
+            for (int i=0;i<_n;i++){
+
+                post[4*i] = inits[4*i+1];
+                post[4*i+1] = inits[4*i];
+                post[4*i+2] = inits[4*i+3];
+                post[4*i+3] = inits[4*i+2];
+            }
+
+            _S.inits_refresh(post.data());
+
+            K -= d;
+            _pos += d;
+
+            _apply_swaps();
+        }
+    }
+
+    /*
+        schedule new coefficients [b0 b1 b2 a1 a2] of all sections that take effect from the sample at position `at` of the stream,
+        i.e., the number of samples filtered since construction. The running initial conditions of every section are kept.
+        Only the sections whose coefficients change get a new table, which is computed by the calling thread, so the filtering
+        thread only exchanges pointers at the boundary and the graph of a running call keeps the tables it was built with.
+     */
+    inline void swap_coefs(const T* coefs,const size_t at){
+
+        assert(_merged.empty());
+
+        Tables_t tabs;
+        {
+            std::lock_guard<std::mutex> lock(*_mutex);
+            tabs = _swaps.empty() ? _tabs : _swaps.back().second;
+        }
+
+        for (int i=0;i<_n;i++){
+
+            const T* c = coefs + 5*i;
+            if (tabs[i]->b1 != c[1] || tabs[i]->b2 != c[2] || tabs[i]->a1 != c[3] || tabs[i]->a2 != c[4])
+                tabs[i] = make_section_table<V>(c);
+        }
+
+        std::lock_guard<std::mutex> lock(*_mutex);
+
+        // keep the swaps in the order of their boundaries
+        auto it = _swaps.begin();
+        while (it != _swaps.end() && it->first <= at) it++;
+        _swaps.insert(it, std::make_pair(at, std::move(tabs)));
+    }
+
+    template<int K> inline void swap_coefs(const T (&coefs)[K][5],const size_t at){
+        swap_coefs(&coefs[0][0],at);
+    }
+
+    // the number of samples filtered since construction, i.e., the position of the next sample in the stream.
+    inline size_t position() const { return _pos; }
+
+    // the current initial conditions of every section in the order of constructor, [xi1 xi2 yi1 yi2] per sos.
+    inline void get_inits(T* inits) {
+
+        auto s = _inits();
+        std::copy(s.begin(), s.end(), inits);
+    }
+
+    /*
+        zero-phase filtering of a whole signal by the current coefficients, forward and then backward. The signal is padded by the
+        odd extension of padlen samples on both sides (3*(2n+1) by default, at most the length of the signal minus 1), and each
+        pass starts in the steady state of its first sample. The samples before the last multiple of M*M run on the single core,
+        forward before and backward after the multi-core graph, which runs both passes over the rest. The state of the stream is
+        not changed.
+     */
+    template<typename InputIt,typename OutputIt> inline OutputIt filtfilt(InputIt first,InputIt last,OutputIt d_first,int padlen=-1){
+
+        assert(_merged.empty());
+
+        const size_t L = M*M;
+        size_t len = std::distance(first,last);
+        if (len == 0) return d_first;
+
+        if (padlen < 0) padlen = 3*(2*_n+1);
+        size_t pad = std::min<size_t>(padlen, len-1);
+
+        std::vector<T> x(first,last), ext(len + 2*pad);
+
+        for (size_t k=0;k<pad;k++){
+
+            ext[k] = 2*x[0] - x[pad-k];
+            ext[pad+len+k] = 2*x[len-1] - x[len-2-k];
+        }
+
+        std::copy(x.begin(), x.end(), ext.begin() + pad);
+
+        // the head on the single core
+        size_t head = ext.size()%L;
+        Series_t S = make_series(_tabs, steady_inits(_tabs, ext[0]).data());
+
+        for (size_t k=0;k<head;k++)
+            ext[k] = S.series_scalar(ext[k]);
+
+        if (ext.size() > head){
+
+            // the multi-core graph continues the forward pass from the state of the head, and hands back the backward state
+            std::vector<T> inits(4*_n), body(ext.begin() + head, ext.end());
+            S.get_inits(inits.data());
+
+            auto y = _MC.filtfilt(body, inits.data());
+
+            std::copy(y.first.begin(), y.first.end(), ext.begin() + head);
+            S.inits_refresh(y.second.data());
+
+        } else {
+
+            S = make_series(_tabs, steady_inits(_tabs, ext.back()).data());
+        }
+
+        for (size_t k=head;k-->0;)
+            ext[k] = S.series_scalar(ext[k]);
+
+        return std::copy(ext.begin() + pad, ext.begin() + pad + len, d_first);
+    }
 };
 
 
+
+
 // Factory function to create MultiCoreFilter instances
 template<typename T, int N> MultiCoreFilter<T, N> makeMultiCoreFilter(const T (&coefs)[N][5], const T (&inits)[N][4]) {
     return MultiCoreFilter<T, N>(coefs, inits);
 }
 
+// Factory function to create MultiCoreFilter instances whose number of sections is only known at runtime, e.g., loaded from configuration.
+template<typename T> MultiCoreFilter<T, Dynamic> makeMultiCoreFilter(const T* coefs, const T* inits, const int n) {
+    return MultiCoreFilter<T, Dynamic>(coefs, inits, n);
+}
+
+// Factory function to create MultiCoreFilter instances whose sections are merged by P/2 into sections of order P, from rest.
+template<int P, typename T> MultiCoreFilter<T, Dynamic> makeMergedFilter(const T* coefs, const int n) {
+    return MultiCoreFilter<T, Dynamic>(coefs, n, std::integral_constant<int,P>{});
+}
+
 #endif // header guard 
@@ -2,10 +2,17 @@
 #define NO_STATE_ZIC_H 1
 
 #include <array>
+#include <cassert>
 #include "vectorclass.h"
+#include "permuteV.h"
 #include "data_block.h"
+#include "section_table.h"
 
-// Stateless zero initial condition that computes the particular part of recursive equation.
+/*
+    Stateless zero initial condition that computes the particular part of recursive equation. The input of the first section
+    of an interpolator is zero-stuffed by U, i.e., only the samples at multiples of U are not zero, and as U divides M each row
+    of a transposed block holds either samples or zeros, so the numerator skips the taps on the rows of zeros.
+ */
 template<typename V> class NoStateZIC{
 
     using T = decltype(std::declval<V>().extract(0));
@@ -13,78 +20,83 @@ template<typename V> class NoStateZIC{
 
     private:
 
-        // coefficients of recursive equation: y_n = x_n + b_1*x_{n-1} + b_2*x_{n-2} + a_1*y_{n-1} + a_2*y_{n-2}
-        T _b1, _b2, _a1, _a2; 
+        // pre-computed coefficients and impulse response vectors of the section, shared with other stages.
+        std::shared_ptr<const SectionTable<V>> _tab;
 
-        // impulse response vectors
-        V _p2, _p1, _h2, _h1;
+        // the mask of the rows of a block that hold samples, bit n for row n
+        unsigned _rows = ~0u;
 
     public:
 
-        NoStateZIC(const T b1, const T b2, const T a1, const T a2, const T xi1=0, const T xi2=0): _b1(b1), _b2(b2), _a1(a1), _a2(a2) {
+        NoStateZIC(const T b1, const T b2, const T a1, const T a2, const T xi1=0, const T xi2=0): _tab(make_section_table<V>(b1, b2, a1, a2)) {};
 
-            // pre-compute matrix B and A.
-            impulse_response();
+        // U: the factor of zero-stuffing of the input, a divisor of M.
+        NoStateZIC(std::shared_ptr<const SectionTable<V>> tab, const int U=1): _tab(std::move(tab)), _rows(rows_of(U)) {};
 
+        // the mask of the rows that hold samples if the input is zero-stuffed by U
+        static inline unsigned rows_of(const int U) {
+
+            assert(U > 0 && M%U == 0);
+
+            if (U == 1) return ~0u;
+
+            unsigned rows = 0;
+            for (auto n=0; n<M; n+=U) rows |= 1u << n;
+
+            return rows;
         };
 
         // multi-block filtering that accepts transposed matrix of samples
         inline DataBlock<V> operator()(DataBlock<V> in) {
 
+            kernel(*_tab, in, _rows);
+
+            return in;
+        };
+
+        // the kernel of multi-block filtering by the coefficients of a table, i.e., SectionTable or TileTable of one block.
+        template<typename Table> static inline void kernel(const Table& t, DataBlock<V>& in, const unsigned rows=~0u) {
+
+            with_zeros(t.zeros, [&](auto z){ kernel<decltype(z)::value>(t, in, rows); });
+        };
+
+        /*
+            the kernel of a pattern of the numerator, an all-pole section does not read the initial conditions of inputs. rows:
+            the mask of the rows that hold samples, the rows before the block always do as their first lanes are x_{-1}, x_{-2}.
+         */
+        template<Zeros Z, typename Table> static inline void kernel(const Table& t, DataBlock<V>& in, const unsigned rows=~0u) {
+
             if (in.last){
 
                 in.post_inits.push_back(in.data[M-2][M-1]);
                 in.post_inits.push_back(in.data[M-1][M-1]);
             };
 
+            auto real = [rows](const int n){ return n < 0 || ((rows >> n) & 1u); };
+
             std::array<V,M> v, w;
 
-            V xi2 = blend8<8,0,1,2,3,4,5,6>(in.data[M-2], in.x_inits[0]);
-            V xi1 = blend8<8,0,1,2,3,4,5,6>(in.data[M-1], in.x_inits[1]);
-            
-            v[0] = mul_add(xi2, _b2, in.data[0]);
-            v[0] = mul_add(xi1, _b1, v[0]);
-            w[0] = v[0];
-            v[1] = mul_add(xi1, _b2, in.data[1]);
-            v[1] = mul_add(in.data[0], _b1, v[1]);
-            w[1] = mul_add(v[0], _a1, v[1]);
+            V xi2, xi1;
 
-            for (auto n=2; n<M; n++) {
+            if constexpr (Z != Zeros::all_pole) {
 
-                v[n] = mul_add(in.data[n-2], _b2, in.data[n]);
-                v[n] = mul_add(in.data[n-1], _b1, v[n]);
-                w[n] = mul_add(w[n-2], _a2, v[n]);
-                w[n] = mul_add(w[n-1], _a1, w[n]);
+                xi2 = lane_shift<1>(in.data[M-2], in.x_inits[0]);
+                xi1 = lane_shift<1>(in.data[M-1], in.x_inits[1]);
             }
 
-            in.data = w;
-
-            return in; 
-        };
-
-        // calculate matrix B and A (see paper). The addition of b_1 and a_1 is the lagged impulse response of recursive equation. 
-        inline void impulse_response() {
-
-            T p2[M], p1[M], h0[M+1];
+            v[0] = numerator<Z>(in.data[0], xi1, xi2, t.b1, t.b2, real(0), true, true);
+            w[0] = v[0];
+            v[1] = numerator<Z>(in.data[1], in.data[0], xi1, t.b1, t.b2, real(1), real(0), true);
+            w[1] = mul_add(v[0], t.a1, v[1]);
 
-            p2[0] = _b2;
-            p2[1] = _a1*_b2;
-            p1[0] = _b1;
-            p1[1] = _a1*_b1 + _b2;
-            h0[0] = 1;
-            h0[1] = _a1;
+            for (auto n=2; n<M; n++) {
 
-            for (auto n=2; n<M+1; n++){
-                p2[n] = _a1*p2[n-1] + _a2*p2[n-2];
-                p1[n] = _a1*p1[n-1] + _a2*p1[n-2];
-                h0[n] = _a1*h0[n-1] + _a2*h0[n-2];  
+                v[n] = numerator<Z>(in.data[n], in.data[n-1], in.data[n-2], t.b1, t.b2, real(n), real(n-1), real(n-2));
+                w[n] = mul_add(w[n-2], t.a2, v[n]);
+                w[n] = mul_add(w[n-1], t.a1, w[n]);
             }
 
-            _p2.load(&p2[0]);
-            _p1.load(&p1[0]);
-            _h2.load(&h0[0]);
-            _h2 *= _a2;
-            _h1.load(&h0[1]);
+            in.data = w;
         };
         
 };
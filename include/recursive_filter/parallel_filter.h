@@ -0,0 +1,352 @@
+#ifndef PARALLEL_FILTER_H
+#define PARALLEL_FILTER_H 1
+
+#include "tbb_iir_multi_core.h"
+#include "matrix_ops.h"
+#include "fir_history.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "simd_vec.h"
+
+// the parallel form of a cascade: branches of second order sections that all filter the input, plus a direct FIR term.
+template<typename T> struct ParallelForm{
+
+    // contiguous coefficients [b0 b1 b2 a1 a2] of the branches, b0 = 1
+    std::vector<T> sos;
+
+    // taps of the direct term, d_0 x_n + d_1 x_{n-1} + ...
+    std::vector<T> fir;
+};
+
+/*
+    partial fraction expansion of n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2], each one with the transfer
+    function (1 + b1 z^{-1} + b2 z^{-2})/(1 - a1 z^{-1} - a2 z^{-2}) as in the recursive equation of the cascade (b0 is not used).
+    The numerator is divided by the product of the denominators, which gives the direct term, and the remainder is solved for
+    the numerator of every denominator. A numerator c is then written as c + s(1 - a1 z^{-1} - a2 z^{-2}) - s with s = 1 - c_0,
+    so every branch is a section of b0 = 1 again and -s goes to the direct term. Sections without poles only add to the
+    numerator. The denominators must not share poles, and poles close to each other make the expansion ill-conditioned.
+ */
+template<typename T> inline ParallelForm<T> parallel_form(const T* coefs, const int n) {
+
+    std::vector<double> B{1}, A{1};
+    std::vector<std::vector<double>> den;
+
+    for (int i=0; i<n; i++){
+
+        const T* c = coefs + 5*i;
+        B = _poly_mul(B, {1, double(c[1]), double(c[2])});
+
+        if (c[4] != 0) den.push_back({1, -double(c[3]), -double(c[4])});
+        else if (c[3] != 0) den.push_back({1, -double(c[3])});
+        else continue;
+
+        A = _poly_mul(A, den.back());
+    }
+
+    while (B.size() > 1 && B.back() == 0) B.pop_back();
+
+    // long division from the highest power of z^{-1}: B = Q A + R
+    const size_t P = A.size() - 1;
+    std::vector<double> Q(B.size() > P ? B.size() - P : 1, 0), R = B;
+
+    for (size_t k=B.size(); k-- > P;){
+
+        double q = R[k]/A[P];
+        Q[k-P] = q;
+        for (size_t j=0; j<=P; j++) R[k-P+j] -= q*A[j];
+    }
+
+    R.resize(P);
+
+    // R = sum over branches of c(z) * product of the other denominators, P equations for P numerator coefficients
+    std::vector<std::vector<double>> S(P, std::vector<double>(P+1, 0));
+    for (size_t k=0, col=0; k<den.size(); k++){
+
+        std::vector<double> others{1};
+        for (size_t j=0; j<den.size(); j++)
+            if (j != k) others = _poly_mul(others, den[j]);
+
+        for (size_t m=0; m<den[k].size()-1; m++, col++)
+            for (size_t r=0; r<others.size(); r++) S[r+m][col] = others[r];
+    }
+
+    for (size_t r=0; r<P; r++) S[r][P] = R[r];
+
+    const std::vector<double> c = _solve(S);
+
+    ParallelForm<T> form;
+
+    for (size_t k=0, col=0; k<den.size(); col += den[k].size()-1, k++){
+
+        double c0 = c[col];
+        double c1 = (den[k].size() == 3) ? c[col+1] : 0;
+
+        double a1 = -den[k][1];
+        double a2 = (den[k].size() == 3) ? -den[k][2] : 0;
+        double s = 1 - c0;
+
+        form.sos.insert(form.sos.end(), {T(1), T(c1 - s*a1), T(-s*a2), T(a1), T(a2)});
+        Q[0] -= s;
+    }
+
+    for (auto q: Q) form.fir.push_back(T(q));
+
+    return form;
+};
+
+template<typename T, int N> inline ParallelForm<T> parallel_form(const T (&coefs)[N][5]) {
+    return parallel_form(&coefs[0][0], N);
+};
+
+/*
+    real function to user: the cascaded second order filter realized in parallel form. The branches have no dependency on each
+    other, so every block of samples is loaded and transposed once and sent to the sections of all the branches at the same
+    time, as the filter bank does. Each branch keeps its output of the block in a slot of its own, and the last branch to reach
+    the block sums the slots in the order of the branches, adds the direct term and stores the block. The initial conditions
+    of the cascade are turned into the ones of the branches and of the direct term, see _parallel_inits.
+ */
+template<typename T> class ParallelFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+    using arrayV = std::array<V,M>;
+
+    private:
+
+        ParallelForm<T> _form;
+
+        // multi-core filter of one section of each branch, which keeps the table and the state of the section
+        std::vector<TBBIIRMultiCore<V>> _MC;
+
+        // single-core section of each branch, sharing the table
+        std::vector<IirCoreOrderTwo<V>> _S;
+
+        // the direct term and the last input samples of the previous call, x_{-q}, ..., x_{-1}
+        FirHistory<T> _fir;
+
+        /*
+            the state of the branches and of the direct term that continues the cascade of n sections coefs from its initial
+            conditions inits [xi1 xi2 yi1 yi2] per section. Every branch takes the inputs before the first section, and the
+            outputs before the branches and the older inputs of the direct term are solved so that the response of the parallel
+            form to zero input matches the one of the cascade over as many samples as there are unknowns, in double precision.
+         */
+        inline void _parallel_inits(const T* coefs,const int n,const T* inits){
+
+            std::vector<T>& hist = _fir.history();
+            const size_t K = _S.size(), q = hist.size(), H = std::max<size_t>(q, 2);
+
+            // unknowns: the inputs x_{-3}, ..., x_{-H}, then yi1 of every branch and yi2 of the branches of second order
+            std::vector<std::pair<size_t,int>> unknown;
+            for (size_t m=2; m<H; m++) unknown.emplace_back(m, -1);
+            for (size_t k=0; k<K; k++){
+
+                unknown.emplace_back(k, 0);
+                if (_form.sos[5*k+4] != 0) unknown.emplace_back(k, 1);
+            }
+
+            const size_t U = unknown.size();
+
+            // the response to zero input of the parallel form from the inputs h[m] = x_{-1-m} and the outputs before the branches
+            auto respond = [&](const std::vector<double>& h, const std::vector<double>& yi){
+
+                std::vector<double> r(U, 0);
+
+                for (size_t k=0; k<K; k++){
+
+                    const T* c = &_form.sos[5*k];
+                    double x1 = h[0], x2 = h[1], y1 = yi[2*k], y2 = yi[2*k+1];
+
+                    for (size_t t=0; t<U; t++){
+
+                        double y = c[1]*x1 + c[2]*x2 + c[3]*y1 + c[4]*y2;
+                        x2 = x1; x1 = 0;
+                        y2 = y1; y1 = y;
+                        r[t] += y;
+                    }
+                }
+
+                for (size_t t=0; t<U; t++)
+                    for (size_t m=t+1; m<_form.fir.size(); m++) r[t] += _form.fir[m]*h[m-t-1];
+
+                return r;
+            };
+
+            // the response to zero input of the cascade
+            std::vector<double> ex(U, 0), s(inits, inits + 4*n);
+            for (size_t t=0; t<U; t++){
+
+                double u = 0;
+                for (int i=0; i<n; i++){
+
+                    const T* c = coefs + 5*i;
+                    double* r = &s[4*i];
+                    double y = u + c[1]*r[0] + c[2]*r[1] + c[3]*r[2] + c[4]*r[3];
+                    r[1] = r[0]; r[0] = u; r[3] = r[2]; r[2] = y;
+                    u = y;
+                }
+                ex[t] = u;
+            }
+
+            std::vector<double> h(H, 0), yi(2*K, 0);
+            h[0] = inits[0];
+            h[1] = inits[1];
+
+            // the known inputs go to the right hand side, every unknown is a column of its own response
+            std::vector<double> r0 = respond(h, yi);
+            std::vector<std::vector<double>> S(U, std::vector<double>(U+1, 0));
+
+            for (size_t j=0; j<U; j++){
+
+                std::vector<double> hj(H, 0), yj(2*K, 0);
+                if (unknown[j].second < 0) hj[unknown[j].first] = 1;
+                else yj[2*unknown[j].first + unknown[j].second] = 1;
+
+                auto rj = respond(hj, yj);
+                for (size_t t=0; t<U; t++) S[t][j] = rj[t];
+            }
+
+            for (size_t t=0; t<U; t++) S[t][U] = ex[t] - r0[t];
+
+            if (U > 0){
+
+                auto sol = _solve(S);
+                for (size_t j=0; j<U; j++){
+
+                    if (unknown[j].second < 0) h[unknown[j].first] = sol[j];
+                    else yi[2*unknown[j].first + unknown[j].second] = sol[j];
+                }
+            }
+
+            for (size_t k=0; k<K; k++){
+
+                // inits_refresh takes xi2, xi1, yi2, yi1
+                const T b[4] = {T(h[1]), T(h[0]), T(yi[2*k+1]), T(yi[2*k])};
+                _S[k].inits_refresh(b);
+            }
+
+            // the history keeps x_{-q}, ..., x_{-1}
+            for (size_t m=0; m<q; m++) hist[q-1-m] = T(h[m]);
+        }
+
+    public:
+
+        /*
+            n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2], see parallel_form, and their initial conditions
+            [xi1 xi2 yi1 yi2], zeros if null. b0 is not used by the parallel form, so the inits assume b0 = 1 as well.
+         */
+        ParallelFilter(const T* coefs,const int n,const T* inits=nullptr): _form(parallel_form(coefs,n)),_fir(_form.fir){
+
+            const T zeros[4] = {0, 0, 0, 0};
+
+            for (size_t k=0;k<_form.sos.size()/5;k++){
+
+                std::vector<std::shared_ptr<const SectionTable<V>>> tabs{make_section_table<V>(&_form.sos[5*k])};
+
+                _MC.emplace_back(tabs, zeros);
+                _S.emplace_back(tabs[0], zeros);
+            }
+
+            if (inits) _parallel_inits(coefs, n, inits);
+        }
+
+        template<int K> ParallelFilter(const T (&coefs)[K][5]): ParallelFilter(&coefs[0][0],K){}
+
+        template<int K> ParallelFilter(const T (&coefs)[K][5],const T (&inits)[K][4]): ParallelFilter(&coefs[0][0],K,&inits[0][0]){}
+
+        // filter len samples, the state of every branch is kept for the next call. in and out may not overlap.
+        inline void operator()(const T* in,T* out,const size_t len){
+
+            assert(in + len <= out || out + len <= in);
+
+            size_t K = _MC.size();
+            size_t h = std::min(_fir.history().size(), len);
+            size_t block_max = (K > 0) ? len/L : 0;
+
+            // whole blocks go multi-core
+            if (block_max > 0){
+
+                // the multi-core filters continue from the state that the single-core sections have reached
+                for (size_t k=0;k<K;k++){
+
+                    T inits[4];
+                    _S[k].get_inits(inits);
+                    _MC[k].set_inits(inits);
+                }
+
+                // the output of each block by every branch, and the number of branches that have filtered the block
+                std::vector<arrayV> slot(block_max*K);
+                std::vector<std::atomic<size_t>> count(block_max);
+
+                // load and transpose each block once for all the branches
+                auto post_inits = TBBIIRMultiCore<V>::run_shared(_MC, block_max,
+                    [&](size_t tag, arrayV& data){
+                        for (auto n = 0; n < M; n++)
+                            data[n].load(in + n*M + tag*L);
+                        data = _permuteV(data);
+                    },
+                    [&](size_t k, size_t tag, arrayV& data){
+
+                        slot[tag*K + k] = data;
+                        if (count[tag].fetch_add(1, std::memory_order_acq_rel) + 1 < K) return;
+
+                        // the sum goes over the branches in a fixed order, so the output does not depend on the order of arrival
+                        arrayV a = slot[tag*K];
+                        for (size_t b = 1; b < K; b++)
+                            for (auto n = 0; n < M; n++)
+                                a[n] += slot[tag*K + b][n];
+
+                        // the last branch of the block stores the sum and adds the direct term, the head is added at the end
+                        arrayV y = _permuteV(a);
+                        for (auto n = 0; n < M; n++)
+                            y[n].store(out + n*M + tag*L);
+
+                        size_t n0 = std::max(tag*L, h);
+                        if (n0 < (tag+1)*L) _fir(in + n0, out + n0, (tag+1)*L - n0, true);
+                    });
+
+                // the single-core sections continue from the state of the multi-core filters
+                for (size_t k=0;k<K;k++)
+                    _S[k].inits_refresh(post_inits[k].data());
+            }
+
+            // the rest samples by the single-core section of each branch
+            size_t n = block_max*L;
+            V v, y;
+
+            for (; n+M <= len; n += M){
+
+                v.load(in + n);
+                y = V(0);
+                for (size_t k=0;k<K;k++) y += _S[k].option1(v);
+                y.store(out + n);
+            }
+
+            for (; n < len; n++){
+
+                T s = 0;
+                for (size_t k=0;k<K;k++) s += _S[k].benchmark(in[n]);
+                out[n] = s;
+            }
+
+            size_t n0 = std::max(block_max*L, h);
+            if (n0 < len) _fir(in + n0, out + n0, len - n0, true);
+
+            // the first outputs of the direct term reach back to the samples of the previous call
+            _fir.head(in, out, len, true);
+        }
+
+        inline const ParallelForm<T>& form() const { return _form; }
+
+        // number of branches
+        inline size_t size() const { return _MC.size(); }
+
+};
+
+#endif // header guard
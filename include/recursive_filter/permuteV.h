@@ -2,6 +2,7 @@
 #define PERMUTEV_H 1
 
 #include <array>
+#include <utility>
 #include "vectorclass.h"
 
 // matrix transpose for different size of matrices
@@ -17,6 +18,44 @@ template<typename V> inline std::array<V,V::size()> _permuteV(const std::array<V
     return matrix_T;
 };
 
+/*
+    reverse the order of the samples in a transposed matrix, i.e., the transposed matrix of the samples in reverse order.
+    The element [n][j] of the transposed matrix is sample j*M+n, so the reverse is [n][j] = [M-1-n][M-1-j].
+ */
+template<typename V, int... I> inline std::array<V,V::size()> _reverseV(const std::array<V,V::size()>& matrix_T, std::integer_sequence<int, I...>) {
+    constexpr int M = V::size();
+    std::array<V,M> reverse_T;
+
+    for (auto n=0; n<M; n++) {
+        // SSE
+        if constexpr (M == 4) reverse_T[n] = permute4<(M-1-I)...>(matrix_T[M-1-n]);
+        // AVX2
+        if constexpr (M == 8) reverse_T[n] = permute8<(M-1-I)...>(matrix_T[M-1-n]);
+        // AVX512
+        if constexpr (M == 16) reverse_T[n] = permute16<(M-1-I)...>(matrix_T[M-1-n]);
+    }
+
+    return reverse_T;
+};
+
+template<typename V> inline std::array<V,V::size()> _reverseV(const std::array<V,V::size()>& matrix_T) {
+    return _reverseV(matrix_T, std::make_integer_sequence<int, V::size()>{});
+};
+
+// shift the lanes of a vector up by S and fill the lowest S lanes, e.g., [f v0 v1 v2 v3 v4 v5 v6] for S = 1 and M = 8.
+template<int S, typename V, int... I> inline V _lane_shift(const V& v, const V& fill, std::integer_sequence<int, I...>) {
+
+    constexpr int M = V::size();
+
+    if constexpr (M == 4) return blend4<(I >= S ? I-S : M)...>(v, fill);
+    if constexpr (M == 8) return blend8<(I >= S ? I-S : M)...>(v, fill);
+    if constexpr (M == 16) return blend16<(I >= S ? I-S : M)...>(v, fill);
+};
+
+template<int S, typename V, typename T> inline V lane_shift(const V& v, const T fill) {
+    return _lane_shift<S>(v, V(fill), std::make_integer_sequence<int, V::size()>{});
+};
+
 // matrix transpose for matrix in size 4 by 4
 template<typename V> inline void _permuteV4(const V matrix[4], V matrix_T[4]) {
     V tmp[4];
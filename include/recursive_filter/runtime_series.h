@@ -0,0 +1,123 @@
+#ifndef RUNTIME_SERIES_H
+#define RUNTIME_SERIES_H 1
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "second_order_cores_serial.h"
+#include "section_table.h"
+
+// form higher order recursive filter by cascading a number of second order cores that is only known at runtime.
+template<typename V> class RuntimeSeries{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    // the largest number of sections that is fused into one compiled kernel.
+    constexpr static int K_max = 8;
+
+    // which core of IirCoreOrderTwo is cascaded.
+    enum class Kernel { scalar, option1, option3 };
+
+    private:
+
+        // second order cores
+        std::vector<IirCoreOrderTwo<V>> _sos;
+
+        // cascaded function of K sections that is unrolled at compile time as Series does.
+        template<Kernel k, int K, typename U> static inline U _fused(IirCoreOrderTwo<V>* sos, U x) {
+
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                if constexpr (k == Kernel::scalar) ((x = sos[I].benchmark(x)), ...);
+                if constexpr (k == Kernel::option1) ((x = sos[I].option1(x)), ...);
+                if constexpr (k == Kernel::option3) ((x = sos[I].option3_middle(x)), ...);
+            }(std::make_index_sequence<K>{});
+
+            return x;
+        };
+
+        // dispatch table over the common numbers of sections, 0 ... K_max.
+        template<Kernel k, typename U, std::size_t... I> static constexpr auto _make_table(std::index_sequence<I...>) {
+            return std::array<U(*)(IirCoreOrderTwo<V>*, U), sizeof...(I)>{&_fused<k, I, U>...};
+        };
+
+        template<Kernel k, typename U> static constexpr auto _table = _make_table<k, U>(std::make_index_sequence<K_max+1>{});
+
+        // run the whole cascade by chunks of K_max fused sections and one dispatched kernel for the remaining sections.
+        template<Kernel k, typename U> inline U _proc(U x) {
+
+            IirCoreOrderTwo<V>* sos = _sos.data();
+            std::size_t n = _sos.size();
+
+            for (; n > K_max; n -= K_max, sos += K_max)
+                x = _fused<k, K_max>(sos, x);
+
+            return _table<k, U>[n](sos, x);
+        };
+
+    public:
+
+        // default constructor
+        RuntimeSeries(){};
+
+        // Parameterized constructor, n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2].
+        RuntimeSeries(const T* coefs, const T* inits, const int n) {
+
+            _sos.reserve(n);
+            for (int i=0; i<n; i++)
+                _sos.emplace_back(coefs + 5*i, inits + 4*i);
+        };
+
+        // Overloaded constructor, share the pre-computed tables of sections with other engines.
+        RuntimeSeries(const std::vector<std::shared_ptr<const SectionTable<V>>>& tabs, const T* inits) {
+
+            _sos.reserve(tabs.size());
+            for (std::size_t i=0; i<tabs.size(); i++)
+                _sos.emplace_back(tabs[i], inits + 4*i);
+        };
+
+        // pass one sample into cascaded higher order filter
+        inline T series_scalar(const T x) {
+            return _proc<Kernel::scalar>(x);
+        };
+
+        // pass one vector of samples into cascaded higher order filter of option 1
+        inline V series_option1(const V x) {
+            return _proc<Kernel::option1>(x);
+        };
+
+        // pass one transposed matrix of samples into cascaded higher order filter of option 3
+        inline std::array<V,M> series_option3(const std::array<V,M>& x) {
+            return _proc<Kernel::option3>(x);
+        };
+
+        // refresh the initial conditions of every section, 4 values per section.
+        inline void inits_refresh(const T* inits) {
+            for (std::size_t i=0; i<_sos.size(); i++)
+                _sos[i].inits_refresh(inits + 4*i);
+        };
+
+        // the current initial conditions of every section, 4 values per section in the order [xi1 xi2 yi1 yi2].
+        inline void get_inits(T* inits) {
+            for (std::size_t i=0; i<_sos.size(); i++)
+                _sos[i].get_inits(inits + 4*i);
+        };
+
+        // replace the tables of sections, the state of every section is kept.
+        inline void tables_refresh(const std::vector<std::shared_ptr<const SectionTable<V>>>& tabs) {
+            for (std::size_t i=0; i<_sos.size(); i++)
+                _sos[i].table_refresh(tabs[i]);
+        };
+
+        inline int size() const { return _sos.size(); }
+
+        // Access the cascaded sections
+        auto& get_series_state() { return _sos; }
+
+};
+
+#endif // header guard
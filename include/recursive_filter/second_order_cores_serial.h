@@ -6,9 +6,11 @@
 #include "zero_init_condition_serial.h"
 #include "init_cond_correction_serial.h"
 #include "permuteV.h"
+#include "section_table.h"
 
-// different combinations of second order cores composed by zic and icc functions
-template<typename V> class IirCoreOrderTwo{
+// different combinations of second order cores composed by zic and icc functions, Z: the pattern of the numerator, e.g.,
+// IirCoreOrderTwo<V,Zeros::lowpass> for the numerator [1 2 1], which is detected from the coefficients by default.
+template<typename V, Zeros Z=Zeros::runtime> class IirCoreOrderTwo{
 
     // V: data type of SIMD vector. T: data type of values in SIMD vector 
     using T = decltype(std::declval<V>().extract(0));
@@ -18,11 +20,11 @@ template<typename V> class IirCoreOrderTwo{
 
     private:
 
-        // coefficients of recursive equation: y_n = x_n + b_1x_{n-1} + b_2x_{n-2} + a_1y_{n-1} + a_2y_{n-2}
-        T _b1, _b2, _a1, _a2; 
+        // pre-computed table of the section, shared by zic and icc (and by the multi-core engine if given).
+        std::shared_ptr<const SectionTable<V>> _tab;
 
         // state for zic 
-        ZeroInitCond<V> _Zic;
+        ZeroInitCond<V,Z> _Zic;
         
         // state for icc
         InitCondCorc<V> _Icc;
@@ -34,23 +36,26 @@ template<typename V> class IirCoreOrderTwo{
 
         // Parameterized constructor, initialize the coefficients and pre-conditions of both parts with seperated values.
         IirCoreOrderTwo(const T b1, const T b2, const T a1, const T a2, const T xi1=0, const T xi2=0, const T yi1=0, const T yi2=0): 
-                        _b1(b1), _b2(b2), _a1(a1), _a2(a2) {
+                        _tab(make_section_table<V>(b1, b2, a1, a2)) {
 
                             // initialize the state of particular part.
-                            _Zic = ZeroInitCond<V>(_b1, _b2, _a1, _a2, xi1, xi2); 
+                            _Zic = ZeroInitCond<V,Z>(_tab, xi1, xi2); 
 
                             // initialize the state of homogeneous part.
-                            _Icc = InitCondCorc<V>(_a1, _a2, yi1, yi2); 
+                            _Icc = InitCondCorc<V>(_tab, yi1, yi2); 
                         };
 
         // Overloaded constructor, initialize the coefficients and pre-conditions of both parts with a vector of values. 
-        IirCoreOrderTwo(const T coefs[5], const T inits[4]): _b1(coefs[1]), _b2(coefs[2]), _a1(coefs[3]), _a2(coefs[4]) {
+        IirCoreOrderTwo(const T coefs[5], const T inits[4]): IirCoreOrderTwo(make_section_table<V>(coefs), inits) {};
+
+        // Overloaded constructor, share a pre-computed table of the section, e.g., with the stages of the multi-core engine.
+        IirCoreOrderTwo(std::shared_ptr<const SectionTable<V>> tab, const T inits[4]): _tab(std::move(tab)) {
 
             // initialize the state of particular part.
-            _Zic = ZeroInitCond<V>(coefs[1], coefs[2], coefs[3], coefs[4], inits[0], inits[1]); 
+            _Zic = ZeroInitCond<V,Z>(_tab, inits[0], inits[1]); 
 
             // initialize the state of homogeneous part.
-            _Icc = InitCondCorc<V>(coefs[3], coefs[4], inits[2], inits[3]); 
+            _Icc = InitCondCorc<V>(_tab, inits[2], inits[3]); 
         };
 
 
@@ -63,6 +68,28 @@ template<typename V> class IirCoreOrderTwo{
             // initialize the state of homogeneous part.
             _Icc.inits_refresh(inits[2], inits[3]); 
         }
+
+        // the current initial conditions of the section in the order of constructor, [xi1 xi2 yi1 yi2].
+        inline void get_inits(T inits[4]){
+
+            auto x = _Zic.inits();
+            auto y = _Icc.inits();
+
+            inits[0] = x[0];
+            inits[1] = x[1];
+            inits[2] = y[0];
+            inits[3] = y[1];
+        }
+
+        // replace the coefficients of the section by a new pre-computed table, the state of both parts is kept.
+        inline void table_refresh(std::shared_ptr<const SectionTable<V>> tab){
+
+            _tab = std::move(tab);
+            _Zic.table_refresh(_tab);
+            _Icc.table_refresh(_tab);
+        }
+
+        inline const std::shared_ptr<const SectionTable<V>>& table() const { return _tab; }
         
 
 
@@ -0,0 +1,325 @@
+#ifndef SECTION_TABLE_H
+#define SECTION_TABLE_H 1
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include "vectorclass.h"
+
+// the number of cascaded sections that is only known at runtime, e.g., MultiCoreFilter<float,Dynamic>.
+constexpr int Dynamic = -1;
+
+/*
+    patterns of the numerator 1 + b1 z^{-1} + b2 z^{-2} that have kernels of their own: all-pole [1 0 0], lowpass [1 2 1],
+    highpass [1 -2 1] and bandpass [1 0 -1]. runtime takes the pattern that the table of the section has detected.
+ */
+enum class Zeros { runtime, general, all_pole, lowpass, highpass, bandpass };
+
+template<typename T> inline Zeros zeros_of(const T b1, const T b2) {
+
+    if (b1 == 0 && b2 == 0) return Zeros::all_pole;
+    if (b1 == 2 && b2 == 1) return Zeros::lowpass;
+    if (b1 == -2 && b2 == 1) return Zeros::highpass;
+    if (b1 == 0 && b2 == -1) return Zeros::bandpass;
+
+    return Zeros::general;
+};
+
+// x_n + b1 x_{n-1} + b2 x_{n-2} of a pattern of the numerator, zero taps are skipped and the taps of 2 are adds.
+template<Zeros Z, typename U, typename T> inline U numerator(const U& x, const U& x1, const U& x2, const T b1, const T b2) {
+
+    if constexpr (Z == Zeros::all_pole) return x;
+    else if constexpr (Z == Zeros::lowpass) return x + (x1 + x1) + x2;
+    else if constexpr (Z == Zeros::highpass) return x - (x1 + x1) + x2;
+    else if constexpr (Z == Zeros::bandpass) return x - x2;
+    else if constexpr (std::is_arithmetic<U>::value) return x + b1*x1 + b2*x2;
+    else return mul_add(x1, b1, mul_add(x2, b2, x));
+};
+
+/*
+    the numerator of a pattern where x, x1 or x2 may be known zeros, e.g., the rows of a zero-stuffed input: r0, r1, r2 tell
+    whether x, x1, x2 hold samples, and the taps on zeros are skipped. Adding a zero is exact, so the result is the same as
+    the one of numerator with the zeros in place.
+ */
+template<Zeros Z, typename U, typename T> inline U numerator(const U& x, const U& x1, const U& x2, const T b1, const T b2,
+                                                             const bool r0, const bool r1, const bool r2) {
+
+    if (r0 && r1 && r2) return numerator<Z>(x, x1, x2, b1, b2);
+
+    U v(0);
+    bool any = r0;
+    if (r0) v = x;
+
+    if constexpr (Z == Zeros::lowpass || Z == Zeros::highpass) {
+
+        if (r1) {
+            U d = x1 + x1;
+            v = !any ? ((Z == Zeros::lowpass) ? d : -d) : (Z == Zeros::lowpass) ? v + d : v - d;
+            any = true;
+        }
+
+        if (r2) v = any ? v + x2 : x2;
+    }
+    else if constexpr (Z == Zeros::bandpass) {
+
+        if (r2) v = any ? v - x2 : -x2;
+    }
+    else if constexpr (Z != Zeros::all_pole) {
+
+        if (r2) {
+            v = any ? mul_add(x2, b2, v) : x2*b2;
+            any = true;
+        }
+
+        if (r1) v = any ? mul_add(x1, b1, v) : x1*b1;
+    }
+
+    return v;
+};
+
+// call f with the pattern of the numerator as a compile time constant, once per block rather than once per sample.
+template<typename F> inline auto with_zeros(const Zeros z, F&& f) {
+
+    switch (z) {
+        case Zeros::all_pole: return f(std::integral_constant<Zeros, Zeros::all_pole>{});
+        case Zeros::lowpass: return f(std::integral_constant<Zeros, Zeros::lowpass>{});
+        case Zeros::highpass: return f(std::integral_constant<Zeros, Zeros::highpass>{});
+        case Zeros::bandpass: return f(std::integral_constant<Zeros, Zeros::bandpass>{});
+        default: return f(std::integral_constant<Zeros, Zeros::general>{});
+    }
+};
+
+/*
+    Immutable pre-computed table of the coefficients of one second order section that works within one block (M*M samples),
+    i.e., everything ZIC_T, ICC_T and the stateless stages read for every data block. It is cheap to compute (O(M)) so that
+    it can be generated for every block when coefficients vary over time.
+ */
+template<typename V> struct alignas(64) TileTable{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    // K: number of recursions in recursive doubling over M lanes, i.e., log2(M).
+    constexpr static int K = (M == 2) ? 1 : (M == 4) ? 2 : (M == 8) ? 3 : 4;
+
+    // coefficients of recursive equation: y_n = x_n + b_1x_{n-1} + b_2x_{n-2} + a_1y_{n-1} + a_2y_{n-2}
+    T b1, b2, a1, a2;
+
+    // the pattern of the numerator
+    Zeros zeros;
+
+    // vectors in matrix B and A, B=[p2 p1], A=[h2 h1].
+    V p2, p1, h2, h1;
+
+    // vectors contain the elements at the four positions of C, C^2, ..., C^M
+    V h_22, h_12, h_21, h_11;
+
+    // vectors including C for recursive doubling within a block, [0]: initialization, [k]: k-th recursion
+    std::array<V,K+1> rd_22, rd_12, rd_21, rd_11;
+
+    TileTable(const T b1_, const T b2_, const T a1_, const T a2_): b1(b1_), b2(b2_), a1(a1_), a2(a2_), zeros(zeros_of(b1_, b2_)) {
+
+        // pre-compute matrix B and A.
+        impulse_response();
+
+        // pre-compute the powers of C within a block and the vectors including C in recursive doubling.
+        C_power();
+    };
+
+    // calculate matrix B and A. The addition of b_1 and a_1 is the lagged impulse response of recursive equation.
+    inline void impulse_response() {
+
+        T p2_[M+1], p1_[M+1], h0[M+1];
+
+        p2_[0] = b2;
+        p2_[1] = a1*b2;
+        p1_[0] = b1;
+        p1_[1] = a1*b1 + b2;
+        h0[0] = 1;
+        h0[1] = a1;
+
+        for (auto n=2; n<M+1; n++){
+            p2_[n] = a1*p2_[n-1] + a2*p2_[n-2];
+            p1_[n] = a1*p1_[n-1] + a2*p1_[n-2];
+            h0[n] = a1*h0[n-1] + a2*h0[n-2];
+        }
+
+        p2.load(&p2_[0]);
+        p1.load(&p1_[0]);
+        h2.load(&h0[0]);
+        h2 *= a2;
+        h1.load(&h0[1]);
+    };
+
+    // calculate vectors contain the elements at the four positions of C, C^2, ..., C^M
+    inline void C_power() {
+
+        T c[4][M];
+
+        c[0][0] = h2[M-2];
+        c[1][0] = h1[M-2];
+        c[2][0] = h2[M-1];
+        c[3][0] = h1[M-1];
+
+        for (auto n=1; n<M; n++) {
+            c[0][n] = h2[M-2]*c[0][n-1] + h2[M-1]*c[1][n-1];
+            c[1][n] = h1[M-2]*c[0][n-1] + h1[M-1]*c[1][n-1];
+            c[2][n] = h2[M-2]*c[2][n-1] + h2[M-1]*c[3][n-1];
+            c[3][n] = h1[M-2]*c[2][n-1] + h1[M-1]*c[3][n-1];
+        }
+
+        h_22.load(c[0]);
+        h_12.load(c[1]);
+        h_21.load(c[2]);
+        h_11.load(c[3]);
+
+        rd_vectors(c, 1, rd_22, rd_12, rd_21, rd_11);
+    };
+
+    /*
+        calculate the vectors including elements of C in recursive doubling from the powers c[.][n] = C^{n+1}. In the k-th recursion
+        with stride s = 2^{k-1}, lane j holds the (p-s+1)-th power of the step matrix if p = j mod 2s >= s, otherwise 0,
+        e.g., [0 C 0 C 0 C 0 C], [0 0 C C^2 0 0 C C^2], [0 0 0 0 C C^2 C^3 C^4] for M = 8. The step matrix is C^stride.
+     */
+    template<typename C, typename A> static inline void rd_vectors(const C& c, const int stride, A& r_22, A& r_12, A& r_21, A& r_11) {
+
+        T r[4][M];
+
+        for (auto k=0; k<(int)r_22.size(); k++) {
+
+            for (auto j=0; j<M; j++) {
+
+                // RD initialization, [C 0 0 0 0 0 0 0]
+                int p = (k == 0) ? ((j == 0) ? 0 : -1) : (j % (2 << (k-1))) - (1 << (k-1));
+
+                for (auto q=0; q<4; q++)
+                    r[q][j] = (p < 0) ? 0 : c[q][stride*(p+1)-1];
+            }
+
+            r_22[k] = load_lanes<typename A::value_type>(r[0]);
+            r_12[k] = load_lanes<typename A::value_type>(r[1]);
+            r_21[k] = load_lanes<typename A::value_type>(r[2]);
+            r_11[k] = load_lanes<typename A::value_type>(r[3]);
+        }
+    };
+
+    // load the first lanes of a vector of possibly fewer lanes than M, e.g., Vec4f for M/2 blocks.
+    template<typename U> static inline U load_lanes(const T* r) {
+
+        if constexpr (std::is_same<U, V>::value) {
+            U u;
+            u.load(r);
+            return u;
+        } else {
+            return U(r[0], r[1], r[2], r[3]);
+        }
+    };
+
+};
+
+// Immutable pre-computed table of one second order section, shared by every stage of the serial and multi-core engines.
+template<typename V> struct alignas(64) SectionTable: public TileTable<V>{
+
+    using T = typename TileTable<V>::T;
+    using TileTable<V>::M;
+    using TileTable<V>::K;
+
+    // C_len: number of powers of C needed by inter block recursive doubling, C^1 ... C^{M*M/2}.
+    constexpr static size_t C_len = M * (M >> 1);
+
+    /*
+        members are ordered by how often the kernels touch them, the within-block part of TileTable comes first,
+        followed by what the inter block recursive doubling and block filtering read.
+     */
+
+    // vectors including C^M for recursive doubling over blocks, [0]: initialization, [k]: k-th recursion
+    std::array<V,K+1> ib_22, ib_12, ib_21, ib_11;
+
+    // the same vectors for half of the blocks (M/2) in inter block recursive doubling
+    std::array<Vec4f,K> ibh_22, ibh_12, ibh_21, ibh_11;
+
+    // scalar powers of C, c_xx[n] is the element of C^{n+1}
+    std::array<T,C_len> c_22, c_12, c_21, c_11;
+
+    // M by M lower triangular toeplitz matrix works for block filtering.
+    std::array<V,M> H;
+
+    SectionTable(const T b1_, const T b2_, const T a1_, const T a2_): TileTable<V>(b1_, b2_, a1_, a2_) {
+
+        // pre-compute the powers of C over blocks.
+        C_power();
+
+        // pre-compute the vectors including C^M in inter block recursive doubling.
+        recursive_doubling_vectors();
+
+        // pre-compute the transition matrix H in block filtering
+        toeplitz();
+    };
+
+    // calculate the powers of C once, the ones of C^M are used between blocks.
+    inline void C_power() {
+
+        const V& h2 = this->h2;
+        const V& h1 = this->h1;
+
+        c_22[0] = h2[M-2];
+        c_12[0] = h1[M-2];
+        c_21[0] = h2[M-1];
+        c_11[0] = h1[M-1];
+
+        for (size_t n=1; n<C_len; n++) {
+            c_22[n] = h2[M-2]*c_22[n-1] + h2[M-1]*c_12[n-1];
+            c_12[n] = h1[M-2]*c_22[n-1] + h1[M-1]*c_12[n-1];
+            c_21[n] = h2[M-2]*c_21[n-1] + h2[M-1]*c_11[n-1];
+            c_11[n] = h1[M-2]*c_21[n-1] + h1[M-1]*c_11[n-1];
+        }
+    };
+
+    // calculate the vectors including elements of C^M in recursive doubling over blocks
+    inline void recursive_doubling_vectors() {
+
+        const std::array<T,C_len>* c[4] = {&c_22, &c_12, &c_21, &c_11};
+        const T* cp[4] = {c[0]->data(), c[1]->data(), c[2]->data(), c[3]->data()};
+
+        TileTable<V>::rd_vectors(cp, M, ib_22, ib_12, ib_21, ib_11);
+
+        // the first 4 lanes of the first recursions are the pattern of M/2 = 4 blocks
+        if constexpr (M >= 4) TileTable<V>::rd_vectors(cp, M, ibh_22, ibh_12, ibh_21, ibh_11);
+    };
+
+    // calculate the transition matrix H for block filtering, which is a lower triangular toplitz matrix.
+    inline void toeplitz() {
+
+        // the first column in H is the exact impulse response, which can be obtained inversely by the addition of h1 and p1.
+        T h[2*M] = {0}, col[M];
+
+        (this->h1+this->p1).store(&col[0]);
+
+        h[M] = 1;
+        for (auto n=1; n<M; n++) h[M+n] = col[n-1];
+
+        // the rest columns are shifted from the first column by 1 position in H
+        for (auto n=0; n<M; n++) H[n].load(&h[M-n]);
+    };
+
+};
+
+// build a table that is shared by reference between all the stages of a section
+template<typename V, typename T> inline std::shared_ptr<const SectionTable<V>> make_section_table(const T b1, const T b2, const T a1, const T a2) {
+    return std::make_shared<const SectionTable<V>>(b1, b2, a1, a2);
+};
+
+// build a table from one row of sos coefficients, [b0 b1 b2 a1 a2]
+template<typename V, typename T> inline std::shared_ptr<const SectionTable<V>> make_section_table(const T coefs[5]) {
+    return std::make_shared<const SectionTable<V>>(coefs[1], coefs[2], coefs[3], coefs[4]);
+};
+
+// build the within-block table of a single block, e.g., for coefficients that vary from block to block.
+template<typename V, typename T> inline std::shared_ptr<const TileTable<V>> make_tile_table(const T b1, const T b2, const T a1, const T a2) {
+    return std::make_shared<const TileTable<V>>(b1, b2, a1, a2);
+};
+
+#endif // header guard
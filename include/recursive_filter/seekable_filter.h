@@ -0,0 +1,207 @@
+#ifndef SEEKABLE_FILTER_H
+#define SEEKABLE_FILTER_H 1
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <cmath>
+#include "multi_core_filter.h"
+#include "zero_gap.h"
+
+/*
+    real function to user: random access to the filtered signal of a long recording. build() runs the filter once over the
+    recording and keeps the initial conditions [xi1 xi2 yi1 yi2] of every section every K samples, then any range [a, b) is
+    filtered from the checkpoint at or before a, so a read costs at most K samples more than its own length, regardless of
+    the position in the recording. The checkpoints can be saved to a side file together with the coefficients.
+ */
+template<typename T> class SeekableFilter{
+
+    private:
+
+        // number of sections and the distance of checkpoints
+        int _n;
+        size_t _K;
+
+        // contiguous coefficients [b0 b1 b2 a1 a2] of the sections
+        std::vector<T> _coefs;
+
+        // the initial conditions of all sections before the samples 0, K, 2K, ...
+        std::vector<T> _checks;
+
+        // the bound of the response to a state, see state_gain, computed by the first edit, negative until then
+        double _G;
+
+        // the identification of a side file
+        constexpr static uint32_t _magic = 0x4b434652;
+
+        // the samples of the decay of a correction between the checks of its size
+        constexpr static size_t _tail = 1024;
+
+    public:
+
+        SeekableFilter(): _n(0), _K(0), _G(-1) {}
+
+        // n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2], a checkpoint every K samples.
+        SeekableFilter(const T* coefs,const int n,const size_t K,const T* inits=nullptr): _n(n),_K(K),_coefs(coefs,coefs + 5*n),_G(-1){
+
+            assert(K > 0);
+
+            _checks.assign(4*n, T(0));
+            if (inits) std::copy(inits, inits + 4*n, _checks.begin());
+        }
+
+        template<int N> SeekableFilter(const T (&coefs)[N][5],const size_t K): SeekableFilter(&coefs[0][0],N,K){}
+
+        template<int N> SeekableFilter(const T (&coefs)[N][5],const T (&inits)[N][4],const size_t K): SeekableFilter(&coefs[0][0],N,K,&inits[0][0]){}
+
+    // filter the whole recording of len samples once and keep the checkpoints, the filtered samples are written to out if given.
+    inline void build(const T* in,const size_t len,T* out=nullptr){
+
+        _checks.resize(4*_n);
+
+        MultiCoreFilter<T> filter(_coefs.data(), _checks.data(), _n);
+
+        std::vector<T> y(out ? 0 : std::min(len, _K));
+
+        for (size_t a = 0; a + _K <= len; a += _K){
+
+            filter(in + a, in + a + _K, out ? out + a : y.data());
+
+            _checks.resize(_checks.size() + 4*_n);
+            filter.get_inits(_checks.data() + _checks.size() - 4*_n);
+        }
+
+        // the samples after the last checkpoint
+        size_t a = len/_K*_K;
+        if (out) filter(in + a, in + len, out + a);
+    }
+
+    // filter the samples [a, b) of the recording in, which starts at sample 0, into out[0 ... b-a).
+    inline void operator()(const T* in,const size_t a,const size_t b,T* out) const {
+
+        assert(a <= b && checkpoints() > 0);
+
+        // the checkpoint at or before a
+        size_t c = std::min(a/_K, size_t(checkpoints() - 1));
+
+        MultiCoreFilter<T> filter(_coefs.data(), _checks.data() + 4*_n*c, _n);
+
+        std::vector<T> skip(a - c*_K);
+        filter(in + c*_K, in + a, skip.data());
+        filter(in + a, in + b, out);
+    }
+
+    /*
+        incremental re-filtering after the samples [a, b) of the recording of len samples have been edited, old: their values
+        before the edit, in: the edited recording. As the filter is linear, the output changes by the response to the change of
+        the input from zero state, which is filtered from a and added to out, the filtered recording, and to the checkpoints
+        after a. Past the edit the correction is the decay of its state, it stops once every further correction is below tol.
+        Returns the end of the patched range.
+     */
+    inline size_t edit(const T* in,const size_t len,const size_t a,const size_t b,const T* old,T* out,const double tol=1e-6){
+
+        assert(a <= b && b <= len);
+
+        if (_G < 0) _G = state_gain(_coefs.data(), _n);
+
+        std::vector<T> zeros(4*_n, T(0)), s(4*_n), d, y;
+        MultiCoreFilter<T> filter(_coefs.data(), zeros.data(), _n);
+
+        size_t pos = a;
+
+        while (pos < len){
+
+            // a segment ends at the next checkpoint, and at the end of the edit or after _tail samples of its decay
+            size_t end = std::min((pos/_K + 1)*_K, len);
+            end = (pos < b) ? std::min(end, b) : std::min(end, pos + _tail);
+
+            d.assign(end - pos, T(0));
+            for (size_t k = pos; k < std::min(end, b); k++) d[k - pos] = in[k] - old[k - a];
+
+            y.resize(d.size());
+            filter(d.begin(), d.end(), y.begin());
+
+            for (size_t k = pos; k < end; k++) out[k] += y[k - pos];
+
+            pos = end;
+            filter.get_inits(s.data());
+
+            // a checkpoint at pos changes by the state of the correction
+            if (pos%_K == 0 && pos/_K < size_t(checkpoints()))
+                for (int j = 0; j < 4*_n; j++) _checks[4*_n*(pos/_K) + j] += s[j];
+
+            double m = 0;
+            for (auto v: s) m = std::max(m, double(std::abs(v)));
+
+            // the largest correction from the state of the correction
+            if (pos >= b && _G*m < tol) break;
+        }
+
+        return pos;
+    }
+
+    // the number of checkpoints, the first one is the initial conditions before sample 0.
+    inline int checkpoints() const { return _n > 0 ? _checks.size()/(4*_n) : 0; }
+
+    inline size_t distance() const { return _K; }
+
+    // the initial conditions of every section before the sample c*K.
+    inline const T* checkpoint(const int c) const { return _checks.data() + 4*_n*c; }
+
+    // write the side file: a header of the sizes, the coefficients and the checkpoints. Returns false if the stream fails.
+    inline bool save(std::ostream& os) const {
+
+        const uint32_t header[4] = {_magic, uint32_t(sizeof(T)), uint32_t(_n), uint32_t(checkpoints())};
+        const uint64_t K = _K;
+
+        os.write(reinterpret_cast<const char*>(header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(&K), sizeof(K));
+        os.write(reinterpret_cast<const char*>(_coefs.data()), _coefs.size()*sizeof(T));
+        os.write(reinterpret_cast<const char*>(_checks.data()), _checks.size()*sizeof(T));
+
+        return bool(os);
+    }
+
+    /*
+        read a side file written by save. Returns false if it is not a side file of the type T, if the sizes in its header
+        exceed the rest of the stream, or if the stream fails.
+     */
+    inline bool load(std::istream& is){
+
+        uint32_t header[4];
+        uint64_t K;
+
+        if (!is.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] != _magic || header[1] != sizeof(T) || header[3] == 0) return false;
+        if (!is.read(reinterpret_cast<char*>(&K), sizeof(K)) || K == 0) return false;
+
+        // the bytes left in the stream bound the sizes before anything is allocated
+        const auto here = is.tellg();
+        if (here < 0 || !is.seekg(0, std::ios::end)) return false;
+
+        const uint64_t left = uint64_t(is.tellg() - here);
+        if (!is.seekg(here)) return false;
+
+        const uint64_t values = 5*uint64_t(header[2]) + 4*uint64_t(header[2])*header[3];
+        if (values > left/sizeof(T)) return false;
+
+        std::vector<T> coefs(5*size_t(header[2])), checks(4*size_t(header[2])*header[3]);
+
+        if (!is.read(reinterpret_cast<char*>(coefs.data()), coefs.size()*sizeof(T))) return false;
+        if (!is.read(reinterpret_cast<char*>(checks.data()), checks.size()*sizeof(T))) return false;
+
+        _n = header[2];
+        _K = K;
+        _coefs = std::move(coefs);
+        _checks = std::move(checks);
+        _G = -1;
+
+        return true;
+    }
+
+};
+
+#endif // header guard
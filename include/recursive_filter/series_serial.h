@@ -3,6 +3,8 @@
 
 #include <array>
 #include <tuple>
+#include <vector>
+#include <memory>
 #include "second_order_cores_serial.h"
 
 // form higher order recursive filter by cascading second order cores
@@ -81,6 +83,30 @@ template<typename... Types> class Series{
             return _proc_option3<0>(x); 
         };
 
+        // refresh the initial conditions of every section, 4 values per section.
+        template<typename U> inline void inits_refresh(const U* inits) {
+            std::apply([&](auto&... sos) {
+                int i = 0;
+                (sos.inits_refresh(inits + 4*i++), ...);
+            }, _t);
+        };
+
+        // the current initial conditions of every section, 4 values per section in the order [xi1 xi2 yi1 yi2].
+        template<typename U> inline void get_inits(U* inits) {
+            std::apply([&](auto&... sos) {
+                int i = 0;
+                (sos.get_inits(inits + 4*i++), ...);
+            }, _t);
+        };
+
+        // replace the tables of sections, the state of every section is kept.
+        template<typename Tables> inline void tables_refresh(const Tables& tabs) {
+            std::apply([&](auto&... sos) {
+                int i = 0;
+                (sos.table_refresh(tabs[i++]), ...);
+            }, _t);
+        };
+
         // Access the tuple
         auto& get_series_state() { return _t; }
 
@@ -118,6 +144,18 @@ auto series_from_coeffs(const T (&coefs)[N][5], const T (&inits)[N][4]={0}) {
     return make_series_from_coeffs<V>(coefs, inits, indices{});
 };
 
+template<typename V, typename Tables, typename T, std::size_t... I>
+auto make_series_from_tables(const Tables& tabs, const T* inits, std::index_sequence<I...>) {
+    using Class = IirCoreOrderTwo<V>;
+    return make_series(Class(tabs[I], inits + 4*I)...); 
+};
+
+// the series that shares the pre-computed tables of sections with other engines instead of computing them again.
+template<typename T, typename V, size_t N, typename indices = std::make_index_sequence<N>>
+auto series_from_tables(const std::vector<std::shared_ptr<const SectionTable<V>>>& tabs, const T* inits) { 
+    return make_series_from_tables<V>(tabs, inits, indices{});
+};
+
 
 // Helper function to apply a function to each element of a tuple
 template<typename Tuple, typename Func, std::size_t... I>
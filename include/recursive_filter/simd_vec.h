@@ -0,0 +1,16 @@
+#ifndef SIMD_VEC_H
+#define SIMD_VEC_H 1
+
+#include <type_traits>
+#include "vectorclass.h"
+
+// select the vector length and type based on the requested instruction set and the type T
+#if INSTRSET >= 9  // AVX512
+    template<typename T> using SimdVec = typename std::conditional<std::is_same<T, float>::value, Vec16f, Vec8d>::type;
+#elif INSTRSET >= 7  // AVX2
+    template<typename T> using SimdVec = typename std::conditional<std::is_same<T, float>::value, Vec8f, Vec4d>::type;
+#else // SSE
+    template<typename T> using SimdVec = typename std::conditional<std::is_same<T, float>::value, Vec4f, Vec2d>::type;
+#endif
+
+#endif // header guard
@@ -0,0 +1,95 @@
+#ifndef SPLIT_FILTER_H
+#define SPLIT_FILTER_H 1
+
+#include "multi_core_filter.h"
+#include "fir_history.h"
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <tbb/tbb.h>
+#include "simd_vec.h"
+
+// product of the numerators g*(b0 + b1 z^{-1} + b2 z^{-2}) of n sections of contiguous coefficients [b0 b1 b2 a1 a2].
+template<typename T> inline std::vector<T> cascade_numerator(const T* coefs, const int n, const T gain=1) {
+
+    std::vector<double> B{double(gain)};
+
+    for (int i=0; i<n; i++){
+
+        const T* c = coefs + 5*i;
+        std::vector<double> B2(B.size()+2, 0);
+
+        for (size_t k=0; k<B.size(); k++)
+            for (auto j=0; j<3; j++) B2[k+j] += B[k]*c[j];
+
+        B = B2;
+    }
+
+    return std::vector<T>(B.begin(), B.end());
+};
+
+/*
+    real function to user: the cascaded second order filter split into its numerator and denominator. All the numerators,
+    with b0 and an overall gain, are multiplied into one FIR of 2n+1 taps, which has no dependency between the outputs and runs
+    over the input in parallel. The poles then go through the cascade of all-pole sections [1 0 0 a1 a2] by MultiCoreFilter, in
+    place, so the sections carry no input state. The filter starts from rest.
+ */
+template<typename T> class SplitFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+
+    private:
+
+        // the combined numerator and the last input samples of the previous call
+        FirHistory<T> _fir;
+
+        // the all-pole sections
+        MultiCoreFilter<T> _poles;
+
+        static inline std::vector<T> all_pole(const T* coefs, const int n){
+
+            std::vector<T> c(5*n, 0);
+            for (int i=0; i<n; i++){
+                c[5*i] = 1;
+                c[5*i+3] = coefs[5*i+3];
+                c[5*i+4] = coefs[5*i+4];
+            }
+
+            return c;
+        }
+
+    public:
+
+        // n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2], b0 is used, and the gain of the whole cascade.
+        SplitFilter(const T* coefs,const int n,const T gain=1)
+        :_fir(cascade_numerator(coefs,n,gain)),_poles(all_pole(coefs,n).data(),std::vector<T>(4*n,0).data(),n){}
+
+        template<int K> SplitFilter(const T (&coefs)[K][5],const T gain=1): SplitFilter(&coefs[0][0],K,gain){}
+
+    // filter len samples, the state is kept for the next call. in and out may not overlap.
+    inline void operator()(const T* in,T* out,const size_t len){
+
+        assert(in + len <= out || out + len <= in);
+
+        // the first outputs reach back to the samples of the previous call
+        const size_t h = _fir.head(in, out, len);
+
+        // the rest straight from the input, over chunks of whole blocks in parallel
+        if (len > h)
+            tbb::parallel_for(tbb::blocked_range<size_t>(h, len, 16*L), [&](const tbb::blocked_range<size_t>& r){
+                _fir(in + r.begin(), out + r.begin(), r.size());
+            });
+
+        // the denominator in place
+        _poles(out, out + len, out);
+    }
+
+    inline const std::vector<T>& numerator() const { return _fir.taps(); }
+
+};
+
+#endif // header guard
@@ -0,0 +1,552 @@
+#ifndef STATE_SPACE_FILTER_H
+#define STATE_SPACE_FILTER_H 1
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include <tbb/tbb.h>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "matrix_ops.h"
+#include "simd_vec.h"
+
+/*
+    Immutable pre-computed table of a whole cascade of n second order sections as one state space system. The state is
+    s = [x_{-1} x_{-2} y^1_{-1} y^1_{-2} ... y^n_{-1} y^n_{-2}], i.e., the inputs before the first section and the outputs before
+    every section, S = 2n+2 values, since the inputs before a section are the outputs before the previous one. Lifted to a row
+    of M samples x, the outputs and the next state are
+
+        y = D x + C s,    s' = A s + B x,
+
+    where D is the M by M lower triangular toeplitz matrix of the impulse response of the cascade. Every matrix is found by
+    running the cascade in double precision from a unit state or a unit input.
+ */
+template<typename V> struct alignas(64) StateSpaceTable{
+
+    // V: data type of SIMD vector. T: data type of values in SIMD vector
+    using T = decltype(std::declval<V>().extract(0));
+
+    // M: length of SIMD vector.
+    constexpr static int M = V::size();
+
+    // K: number of recursions in recursive doubling over M lanes, i.e., log2(M).
+    constexpr static int K = (M == 2) ? 1 : (M == 4) ? 2 : (M == 8) ? 3 : 4;
+
+    // number of sections and size of state
+    int n, S;
+
+    // coefficients of each section: b1 b2 a1 a2
+    std::vector<std::array<T,4>> coefs;
+
+    // lifted matrices in row major, A: S by S, B: S by M, C: M by S, D: M by M
+    std::vector<T> A, B, C, D;
+
+    // A^{2^k} for recursive doubling over lanes
+    std::vector<std::vector<T>> Ap;
+
+    // A^M for the recursion between the tiles of M*M samples
+    std::vector<T> AL;
+
+    // the elements of A^{j+1} in lane j, [p*S+q]
+    std::vector<V> A_lanes;
+
+    // the columns of C and D as vectors over a row of samples, Cv[q] lane m = C[m][q], Dv[k] lane m = D[m][k]
+    std::vector<V> Cv, Dv;
+
+    // one sample through the cascade, the state s is updated.
+    template<typename U> static inline U step(const std::vector<std::array<T,4>>& c, U* s, U x) {
+
+        const int n = c.size();
+
+        // the inputs before section i are the outputs before section i-1, so all the outputs are found before the shift
+        U u = x;
+        for (int i=0; i<n; i++){
+
+            U y = u + c[i][0]*s[2*i] + c[i][1]*s[2*i+1] + c[i][2]*s[2*i+2] + c[i][3]*s[2*i+3];
+
+            s[2*i+1] = s[2*i];
+            s[2*i] = u;
+            u = y;
+        }
+
+        s[2*n+1] = s[2*n];
+        s[2*n] = u;
+
+        return u;
+    };
+
+    // n sections of contiguous coefficients [b0 b1 b2 a1 a2], b0 is not used.
+    StateSpaceTable(const T* coefs_, const int n_): n(n_), S(2*n_+2) {
+
+        for (auto i=0; i<n; i++)
+            coefs.push_back({coefs_[5*i+1], coefs_[5*i+2], coefs_[5*i+3], coefs_[5*i+4]});
+
+        A.assign(S*S, 0); B.assign(S*M, 0); C.assign(M*S, 0); D.assign(M*M, 0);
+
+        std::vector<double> s(S);
+
+        // the response of a row to a unit state, column q of C and A
+        for (auto q=0; q<S; q++){
+
+            std::fill(s.begin(), s.end(), 0);
+            s[q] = 1;
+
+            for (auto m=0; m<M; m++) C[m*S+q] = T(step(coefs, s.data(), 0.0));
+            for (auto p=0; p<S; p++) A[p*S+q] = T(s[p]);
+        }
+
+        // the response of a row from zero state to a unit input at k, column k of D and B
+        for (auto k=0; k<M; k++){
+
+            std::fill(s.begin(), s.end(), 0);
+
+            for (auto m=0; m<M; m++) D[m*M+k] = T(step(coefs, s.data(), (m == k) ? 1.0 : 0.0));
+            for (auto p=0; p<S; p++) B[p*M+k] = T(s[p]);
+        }
+
+        Ap.push_back(A);
+        for (auto k=1; k<K; k++) Ap.push_back(_mat_mul(Ap[k-1], Ap[k-1], S));
+
+        std::vector<T> Aj = A;
+        std::vector<T> lanes(S*S*M);
+        for (auto j=0; j<M; j++){
+            for (auto i=0; i<S*S; i++) lanes[i*M+j] = Aj[i];
+            Aj = _mat_mul(Aj, A, S);
+        }
+
+        // Aj = A^{M+1} after the loop, the last lane holds A^M
+        A_lanes.resize(S*S);
+        AL.resize(S*S);
+        for (auto i=0; i<S*S; i++){
+            A_lanes[i].load(&lanes[i*M]);
+            AL[i] = lanes[i*M+M-1];
+        }
+
+        T col[M];
+        Cv.resize(S);
+        for (auto q=0; q<S; q++){
+            for (auto m=0; m<M; m++) col[m] = C[m*S+q];
+            Cv[q].load(col);
+        }
+
+        Dv.resize(M);
+        for (auto k=0; k<M; k++){
+            for (auto m=0; m<M; m++) col[m] = D[m*M+k];
+            Dv[k].load(col);
+        }
+    };
+
+};
+
+template<typename V, typename T> inline std::shared_ptr<const StateSpaceTable<V>> make_state_space_table(const T* coefs, const int n) {
+    return std::make_shared<const StateSpaceTable<V>>(coefs, n);
+};
+
+/*
+    serial core of the state space realization. A transposed tile of M*M samples, lane j = row j, takes three dense steps:
+    the outputs and the end state of every row from zero state (one matrix product of D and B each, no dependency between the
+    FMAs), the states before the rows by recursive doubling over lanes with A^{2^k}, and the correction of the outputs by C.
+    A cascade of n sections costs about M/2 + 2S + (K+1)S^2/M multiply-adds per sample, which is worth it over the sections for
+    moderate orders, when the chain of dependencies through the sections is the bottleneck.
+ */
+template<typename V> class StateSpaceCore{
+
+    using T = decltype(std::declval<V>().extract(0));
+    constexpr static int M = V::size();
+    constexpr static int K = StateSpaceTable<V>::K;
+
+    private:
+
+        std::shared_ptr<const StateSpaceTable<V>> _tab;
+
+        // the state before the next sample and the next state of option 1
+        std::vector<T> _s, _s_next;
+
+        // the end states of the lanes of option 3 and the scratch of join, allocated once
+        std::vector<V> _z, _zs;
+
+        template<int P> static inline void _join(const StateSpaceTable<V>& t, const std::vector<T>& F, V* z, V* zs) {
+
+            const int S = t.S;
+
+            for (auto q=0; q<S; q++) zs[q] = lane_shift<P>(z[q], T(0));
+
+            for (auto p=0; p<S; p++)
+                for (auto q=0; q<S; q++)
+                    z[p] = mul_add(zs[q], F[p*S+q], z[p]);
+        };
+
+    public:
+
+        StateSpaceCore(){};
+
+        // inits: initial conditions of every section [xi1 xi2 yi1 yi2], only xi1 and xi2 of the first section are used for
+        // the inputs, the inputs before the other sections are the outputs before the previous one. Zeros if inits is null.
+        StateSpaceCore(std::shared_ptr<const StateSpaceTable<V>> tab, const T* inits=nullptr): _tab(std::move(tab)), _s(_tab->S, 0), _s_next(_tab->S, 0), _z(_tab->S), _zs(_tab->S) {
+            if (inits) inits_refresh(inits);
+        };
+
+        StateSpaceCore(const T* coefs, const int n, const T* inits=nullptr): StateSpaceCore(make_state_space_table<V>(coefs, n), inits) {};
+
+        inline void inits_refresh(const T* inits){
+
+            _s[0] = inits[0];
+            _s[1] = inits[1];
+            for (auto i=0; i<_tab->n; i++){
+                _s[2*i+2] = inits[4*i+2];
+                _s[2*i+3] = inits[4*i+3];
+            }
+        }
+
+        // the current initial conditions of every section [xi1 xi2 yi1 yi2].
+        inline void get_inits(T* inits) const {
+
+            for (auto i=0; i<_tab->n; i++)
+                for (auto q=0; q<4; q++) inits[4*i+q] = _s[2*i+q];
+        }
+
+        inline std::vector<T>& state() { return _s; }
+
+        inline const std::shared_ptr<const StateSpaceTable<V>>& table() const { return _tab; }
+
+        inline T benchmark(const T x) {
+            return StateSpaceTable<V>::step(_tab->coefs, _s.data(), x);
+        };
+
+        // one row of M samples, y = D x + C s, s' = A s + B x
+        inline V option1(const V x) {
+
+            const StateSpaceTable<V>& t = *_tab;
+            const int S = t.S;
+
+            V y{0};
+            for (auto k=0; k<M; k++) y = mul_add(t.Dv[k], x[k], y);
+            for (auto q=0; q<S; q++) y = mul_add(t.Cv[q], _s[q], y);
+
+            for (auto p=0; p<S; p++){
+                T v = 0;
+                for (auto q=0; q<S; q++) v += t.A[p*S+q]*_s[q];
+                for (auto k=0; k<M; k++) v += t.B[p*M+k]*x[k];
+                _s_next[p] = v;
+            }
+            std::swap(_s, _s_next);
+
+            return y;
+        };
+
+        // the outputs w and the end states z of every lane of a transposed tile from zero state
+        static inline void zero_state(const StateSpaceTable<V>& t, const std::array<V,M>& x_T, std::array<V,M>& w, V* z) {
+
+            const int S = t.S;
+
+            for (auto m=0; m<M; m++){
+                w[m] = x_T[0]*t.D[m*M];
+                for (auto k=1; k<=m; k++) w[m] = mul_add(x_T[k], t.D[m*M+k], w[m]);
+            }
+
+            for (auto p=0; p<S; p++){
+                z[p] = x_T[0]*t.B[p*M];
+                for (auto k=1; k<M; k++) z[p] = mul_add(x_T[k], t.B[p*M+k], z[p]);
+            }
+        };
+
+        // the end states of the lanes from zero state before the tile by recursive doubling over lanes, zs: scratch of S vectors
+        static inline void join(const StateSpaceTable<V>& t, V* z, V* zs) {
+
+            [&]<int... k>(std::integer_sequence<int, k...>) {
+                (_join<(1 << k)>(t, t.Ap[k], z, zs), ...);
+            }(std::make_integer_sequence<int, K>{});
+        };
+
+        // add the response to the state s before the tile into the joined end states z and outputs w, the state after the
+        // tile is returned in s.
+        static inline void correct(const StateSpaceTable<V>& t, T* s, V* z, std::array<V,M>& w) {
+
+            const int S = t.S;
+
+            for (auto p=0; p<S; p++)
+                for (auto q=0; q<S; q++)
+                    z[p] = mul_add(t.A_lanes[p*S+q], s[q], z[p]);
+
+            for (auto q=0; q<S; q++){
+
+                // the state before each lane
+                V si = lane_shift<1>(z[q], s[q]);
+
+                for (auto m=0; m<M; m++) w[m] = mul_add(si, t.C[m*S+q], w[m]);
+            }
+
+            for (auto q=0; q<S; q++) s[q] = z[q][M-1];
+        };
+
+        // the option 3, multi-block filtering: T - state space - T
+        inline std::array<V,M> option3(const std::array<V,M>& x) {
+            return _permuteV(option3_middle(_permuteV(x)));
+        };
+
+        inline std::array<V,M> option3_middle(const std::array<V,M>& x_T) {
+
+            const StateSpaceTable<V>& t = *_tab;
+
+            std::array<V,M> w;
+
+            zero_state(t, x_T, w, _z.data());
+            join(t, _z.data(), _zs.data());
+            correct(t, _s.data(), _z.data(), w);
+
+            return w;
+        };
+
+};
+
+/*
+    real function to user: the cascaded second order filter realized as one state space system. The tiles of M*M samples are
+    independent from zero state, so they run in parallel, then the states before the tiles follow from the end states of the
+    tiles from zero state, s_{t+1} = A^M s_t + e_t. This recursion is a chunked scan: the groups of tiles find their own end
+    states from zero state in parallel, only the states before the groups run in order by the power of A^M over a group, and
+    every group corrects its tiles in order from its state in parallel again.
+ */
+template<typename T> class StateSpaceFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+    using arrayV = std::array<V,M>;
+
+    private:
+
+        StateSpaceCore<V> _core;
+
+    public:
+
+        // n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2], see
+        // StateSpaceCore for the initial conditions.
+        StateSpaceFilter(const T* coefs,const int n,const T* inits=nullptr): _core(coefs,n,inits){}
+
+        template<int K> StateSpaceFilter(const T (&coefs)[K][5],const T (&inits)[K][4]): StateSpaceFilter(&coefs[0][0],K,&inits[0][0]){}
+
+        template<int K> StateSpaceFilter(const T (&coefs)[K][5]): StateSpaceFilter(&coefs[0][0],K){}
+
+    private:
+
+        // the outputs from zero state of every tile in parallel, which stay transposed in place, and their joined end states z
+        inline void _zero_pass(const T* in,T* out,const size_t tiles,std::vector<V>& z) const {
+
+            const StateSpaceTable<V>& t = *_core.table();
+            const int S = t.S;
+
+            z.resize(tiles*S);
+
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, tiles), [&](const tbb::blocked_range<size_t>& r){
+
+                std::vector<V> zs(S);
+
+                for (size_t b = r.begin(); b != r.end(); b++){
+
+                    arrayV x, w;
+                    for (auto m = 0; m < M; m++) x[m].load(in + b*L + m*M);
+
+                    StateSpaceCore<V>::zero_state(t, _permuteV(x), w, &z[b*S]);
+                    StateSpaceCore<V>::join(t, &z[b*S], zs.data());
+
+                    for (auto m = 0; m < M; m++) w[m].store(out + b*L + m*M);
+                }
+            });
+        }
+
+        // the number of tiles in a group of the scan, enough groups to keep every core busy in both parallel passes
+        static inline size_t _group(const size_t tiles){
+
+            const size_t groups = std::min<size_t>(tiles, 4*tbb::this_task_arena::max_concurrency());
+            return (tiles + groups - 1)/groups;
+        }
+
+        /*
+            the states before the groups of c tiles from the state s0 before the first tile, and the state after the last tile
+            at the end. Each group runs s' = A^M s + e over its tiles from zero state in parallel, then the states before the
+            groups follow in order in double precision by (A^M)^c, and by the power of the length of the last group.
+         */
+        inline std::vector<T> _scan(const size_t tiles,const size_t c,const std::vector<V>& z,const std::vector<T>& s0) const {
+
+            const StateSpaceTable<V>& t = *_core.table();
+            const int S = t.S;
+            const size_t groups = (tiles + c - 1)/c;
+
+            std::vector<T> e(groups*S, 0), s((groups+1)*S);
+
+            tbb::parallel_for(size_t(0), groups, [&](size_t g){
+
+                std::vector<T> v(S);
+                T* eg = &e[g*S];
+
+                for (size_t b = g*c; b < std::min(tiles, (g+1)*c); b++){
+
+                    for (auto p = 0; p < S; p++){
+
+                        v[p] = z[b*S+p][M-1];
+                        for (auto q = 0; q < S; q++) v[p] += t.AL[p*S+q]*eg[q];
+                    }
+                    std::copy(v.begin(), v.end(), eg);
+                }
+            });
+
+            std::vector<double> AL(t.AL.begin(), t.AL.end());
+            const std::vector<double> Ac = _mat_power(AL, c, S), Ar = _mat_power(AL, tiles - (groups-1)*c, S);
+
+            std::vector<double> sd(s0.begin(), s0.end()), v(S);
+            std::copy(s0.begin(), s0.end(), s.begin());
+
+            for (size_t g = 0; g < groups; g++){
+
+                const std::vector<double>& F = (g+1 < groups) ? Ac : Ar;
+
+                for (auto p = 0; p < S; p++){
+
+                    v[p] = e[g*S+p];
+                    for (auto q = 0; q < S; q++) v[p] += F[p*S+q]*sd[q];
+                }
+                sd.swap(v);
+                std::copy(sd.begin(), sd.end(), s.begin() + (g+1)*S);
+            }
+
+            return s;
+        }
+
+        // the states before the groups of tiles by the scan from the state s0 before the first tile, then every group corrects
+        // its tiles in order from its state in parallel. s0 takes the state after the last tile.
+        inline void _correct_pass(T* out,const size_t tiles,std::vector<V>& z,std::vector<T>& s0) const {
+
+            const StateSpaceTable<V>& t = *_core.table();
+            const int S = t.S;
+            const size_t c = _group(tiles), groups = (tiles + c - 1)/c;
+
+            std::vector<T> s = _scan(tiles, c, z, s0);
+
+            tbb::parallel_for(size_t(0), groups, [&](size_t g){
+
+                // correct() carries the state of the group over its tiles
+                T* sg = &s[g*S];
+
+                for (size_t b = g*c; b < std::min(tiles, (g+1)*c); b++){
+
+                    arrayV w;
+                    for (auto m = 0; m < M; m++) w[m].load(out + b*L + m*M);
+
+                    StateSpaceCore<V>::correct(t, sg, &z[b*S], w);
+
+                    w = _permuteV(w);
+                    for (auto m = 0; m < M; m++) w[m].store(out + b*L + m*M);
+                }
+            });
+
+            std::copy(s.end() - S, s.end(), s0.begin());
+        }
+
+        // the rest samples after the tiles by rows and by scalar
+        static inline void _rest(StateSpaceCore<V>& core,const T* in,T* out,size_t n,const size_t len){
+
+            V v;
+
+            for (; n+M <= len; n += M)
+                core.option1(v.load(in + n)).store(out + n);
+
+            for (; n < len; n++)
+                out[n] = core.benchmark(in[n]);
+        }
+
+    public:
+
+    // filter len samples, the state is kept for the next call.
+    inline void operator()(const T* in,T* out,const size_t len){
+
+        const size_t tiles = len/L;
+
+        if (tiles > 0){
+
+            std::vector<V> z;
+            _zero_pass(in, out, tiles, z);
+            _correct_pass(out, tiles, z, _core.state());
+        }
+
+        _rest(_core, in, out, tiles*L, len);
+    }
+
+    /*
+        circular filtering: in is one period of a periodic signal, e.g., a closed contour or a periodic row of an image, and out
+        is the periodic steady state, as if the periodic signal had been filtered forever. The state s before the period is the
+        one that the period brings back, s = P s + e, where P is the transition over the period, A^M to the power of the number
+        of tiles by repeated squaring times the transitions of the rest, and e is the end state from zero state. So the samples
+        take one zero-state pass and one correction pass, without repeated sweeps. The state of the stream is not used.
+     */
+    inline void circular(const T* in,T* out,const size_t len){
+
+        const StateSpaceTable<V>& t = *_core.table();
+        const int S = t.S;
+        const size_t tiles = len/L, rows = (len - tiles*L)/M, scalars = len - tiles*L - rows*M;
+
+        if (len == 0) return;
+
+        std::vector<V> z;
+        _zero_pass(in, out, tiles, z);
+
+        // the end state of the period from zero state by the scan, the rest samples run again after the correction
+        std::vector<T> e_T(S, 0);
+        if (tiles > 0){
+
+            auto s = _scan(tiles, _group(tiles), z, e_T);
+            std::copy(s.end() - S, s.end(), e_T.begin());
+        }
+
+        StateSpaceCore<V> rest(_core.table());
+        rest.state() = e_T;
+
+        std::vector<T> y(len - tiles*L);
+        _rest(rest, in + tiles*L, y.data(), 0, y.size());
+
+        std::vector<double> e(rest.state().begin(), rest.state().end());
+
+        // the transition over the period in double precision
+        std::vector<double> P = _mat_power(std::vector<double>(t.AL.begin(), t.AL.end()), tiles, S), A(t.A.begin(), t.A.end());
+
+        for (size_t r = 0; r < rows; r++) P = _mat_mul(A, P, S);
+
+        // the scalars step every column of the transition
+        std::vector<double> col(S);
+        for (auto q = 0; q < S; q++){
+
+            for (auto p = 0; p < S; p++) col[p] = P[p*S+q];
+            for (size_t k = 0; k < scalars; k++) StateSpaceTable<V>::step(t.coefs, col.data(), 0.0);
+            for (auto p = 0; p < S; p++) P[p*S+q] = col[p];
+        }
+
+        // the periodic state solves (I - P) s = e, a pole on the unit circle that the period resonates with has none
+        std::vector<std::vector<double>> E(S, std::vector<double>(S+1));
+        for (auto p = 0; p < S; p++){
+
+            for (auto q = 0; q < S; q++) E[p][q] = ((p == q) ? 1.0 : 0.0) - P[p*S+q];
+            E[p][S] = e[p];
+        }
+
+        e = _solve(E);
+
+        std::vector<T> s0(e.begin(), e.end());
+
+        if (tiles > 0) _correct_pass(out, tiles, z, s0);
+
+        rest.state() = s0;
+        _rest(rest, in, out, tiles*L, len);
+    }
+
+    inline void get_inits(T* inits) const { _core.get_inits(inits); }
+
+    // number of values in the state
+    inline int state_size() const { return _core.table()->S; }
+
+};
+
+#endif // header guard
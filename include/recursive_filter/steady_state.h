@@ -0,0 +1,52 @@
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H 1
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include "section_table.h"
+
+/*
+    initial conditions [xi1 xi2 yi1 yi2] of one section in the steady state of a constant input u, i.e., the output level is
+    the DC gain (1+b1+b2)/(1-a1-a2) times u. A section with a pole at DC has no steady state, it starts from rest with its
+    inputs and outputs 0, as if u only started at the first sample. The pole is at DC within the rounding of a1 and a2 to T,
+    e.g., a1 = 1.8, a2 = -0.8 in float. Returns the output level, which is the input level of the next section.
+ */
+template<typename T> inline T steady_inits(const T b1, const T b2, const T a1, const T a2, const T u, T inits[4]) {
+
+    const double d = 1 - double(a1) - double(a2);
+    const bool dc_pole = std::abs(d) <= std::numeric_limits<T>::epsilon()*(1 + std::abs(double(a1)) + std::abs(double(a2)));
+    T y = dc_pole ? T(0) : T(u*(1 + double(b1) + double(b2))/d);
+
+    inits[0] = dc_pole ? T(0) : u;
+    inits[1] = dc_pole ? T(0) : u;
+    inits[2] = y;
+    inits[3] = y;
+
+    return y;
+};
+
+// steady-state initial conditions of n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2] for a constant input u.
+template<typename T> inline void steady_inits(const T* coefs, const int n, T u, T* inits) {
+
+    for (int i=0; i<n; i++)
+        u = steady_inits(coefs[5*i+1], coefs[5*i+2], coefs[5*i+3], coefs[5*i+4], u, inits + 4*i);
+};
+
+template<typename T, int N> inline void steady_inits(const T (&coefs)[N][5], const T u, T (&inits)[N][4]) {
+    steady_inits(&coefs[0][0], N, u, &inits[0][0]);
+};
+
+// steady-state initial conditions of cascaded sections given by their pre-computed tables.
+template<typename V, typename T> inline std::vector<T> steady_inits(const std::vector<std::shared_ptr<const SectionTable<V>>>& tabs, T u) {
+
+    std::vector<T> inits(4*tabs.size());
+
+    for (size_t i=0; i<tabs.size(); i++)
+        u = steady_inits(tabs[i]->b1, tabs[i]->b2, tabs[i]->a1, tabs[i]->a2, u, inits.data() + 4*i);
+
+    return inits;
+};
+
+#endif // header guard
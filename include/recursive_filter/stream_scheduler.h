@@ -0,0 +1,276 @@
+#ifndef STREAM_SCHEDULER_H
+#define STREAM_SCHEDULER_H 1
+
+#include <array>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <tbb/tbb.h>
+#include "vectorclass.h"
+#include "permuteV.h"
+#include "multi_channel_filter.h"
+#include "simd_vec.h"
+
+/*
+    real function to user: many live streams, each with its own cascaded second order filter and state, that receive small
+    packets at any time. A stream is only a few coefficients and states in flat arrays, no filter object is kept per stream.
+    The packets are queued by push and filtered by run: the pending streams with the same number of sections are packed into
+    the lanes of SIMD vectors with the coefficients of every lane in its own lane, the batches run on different cores and
+    the outputs are written to where the packets point to. A lane takes the next stream of its batch when its stream ends, see
+    LaneCascade::run.
+
+    Threading: push, add_stream, set_inits, set_coefs, streams and pending may be called from any thread at any time, also while
+    run is filtering. New streams and changes of inits and coefficients are queued and take effect, in the order of the calls,
+    at the start of the next run, before its packets are filtered. Calls of run are serialized, so the packets of a stream are
+    always filtered in order by one run, and get_inits waits for a running run.
+ */
+template<typename T> class StreamScheduler{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+
+    // the cascade with the coefficients of every lane in its own lane, and the state of one section in every lane
+    using State = std::array<V,4>;
+    using Cascade = LaneCascade<V,State>;
+
+    // one packet of a stream, filtered from in to out by the next run
+    struct Packet{
+
+        int id;
+        const T* in;
+        T* out;
+        size_t len;
+    };
+
+    // the pending packets of one stream, p[first], ..., p[last-1] in the order they were pushed
+    struct Job{
+
+        int id;
+        size_t first, last, len;
+    };
+
+    private:
+
+        // number of sections of each stream and the offset of its sections in the flat arrays
+        std::vector<int> _n;
+        std::vector<size_t> _offset;
+
+        // coefficients [b1 b2 a1 a2] and state [xi1 xi2 yi1 yi2] of every section of every stream
+        std::vector<T> _coefs, _state;
+
+        // number of streams a batch is made of per lane
+        size_t _per_lane;
+
+        std::vector<Packet> _pending;
+
+        // number of sections of every stream including the ones that are queued, and the queued changes of streams
+        std::vector<int> _sections;
+        std::vector<std::function<void()>> _changes;
+
+        // _mutex guards the queues, _run_mutex the flat arrays, which only run and get_inits touch
+        std::mutex _mutex, _run_mutex;
+
+        // apply the queued changes to the flat arrays, _run_mutex is held. The queued packets are taken into p in the same
+        // lock if p is given, so they only refer to streams that are added by then.
+        inline void _apply_changes(std::vector<Packet>* p=nullptr){
+
+            std::vector<std::function<void()>> changes;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                changes.swap(_changes);
+                if (p) p->swap(_pending);
+            }
+
+            for (auto& c: changes) c();
+        }
+
+        // filter the jobs[b], jobs[b+stride], ... of streams of n sections by one vector of lanes.
+        inline void _batch(const std::vector<Packet>& p, const std::vector<Job>& jobs, const size_t b, const size_t stride, const int n){
+
+            Cascade sos(n);
+            std::vector<State> s(n);
+
+            // the job in each lane (-1: none) and its current packet
+            std::array<long,M> r;
+            std::array<size_t,M> k;
+            r.fill(-1);
+            size_t next = b;
+
+            // go to the next packet of the stream in lane j, or keep the state of the stream that ends and take the next one
+            sos.run(s.data(), [&](int j, const T*& in, T*& out, size_t& len){
+
+                if (r[j] >= 0 && ++k[j] < jobs[r[j]].last){
+
+                    in = p[k[j]].in;
+                    out = p[k[j]].out;
+                    len = p[k[j]].len;
+
+                    return true;
+                }
+
+                if (r[j] >= 0) sos.get_lane(s.data(), j, &_state[_offset[jobs[r[j]].id]]);
+
+                r[j] = (next < jobs.size()) ? long(next) : -1;
+                next += stride;
+
+                const T* coefs = (r[j] >= 0) ? &_coefs[_offset[jobs[r[j]].id]] : nullptr;
+                const T* state = (r[j] >= 0) ? &_state[_offset[jobs[r[j]].id]] : nullptr;
+
+                sos.set_lane_coefs(j, coefs);
+                sos.set_lane(s.data(), j, state);
+
+                if (r[j] < 0) return false;
+
+                k[j] = jobs[r[j]].first;
+                in = p[k[j]].in;
+                out = p[k[j]].out;
+                len = p[k[j]].len;
+
+                return true;
+            });
+        }
+
+    public:
+
+        // a batch takes per_lane streams per lane on average.
+        StreamScheduler(const size_t per_lane=4): _per_lane(per_lane){}
+
+        // add a stream of n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2] (zeros
+        // if null), returns the id of the stream, which packets can be pushed for right away.
+        inline int add_stream(const T* coefs,const T* inits,const int n){
+
+            std::vector<T> c, s;
+            for (int i=0;i<n;i++){
+                for (auto q=0; q<4; q++){
+                    c.push_back(coefs[5*i+1+q]);
+                    s.push_back(inits ? inits[4*i+q] : T(0));
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            _changes.push_back([this, n, c = std::move(c), s = std::move(s)](){
+
+                _n.push_back(n);
+                _offset.push_back(_coefs.size());
+                _coefs.insert(_coefs.end(), c.begin(), c.end());
+                _state.insert(_state.end(), s.begin(), s.end());
+            });
+
+            _sections.push_back(n);
+            return _sections.size() - 1;
+        }
+
+        template<int K> inline int add_stream(const T (&coefs)[K][5],const T (&inits)[K][4]){
+            return add_stream(&coefs[0][0],&inits[0][0],K);
+        }
+
+        // queue a packet of len samples of stream id, it is filtered from in to out by the next run. Safe to call from any thread.
+        inline void push(const int id,const T* in,T* out,const size_t len){
+
+            if (len == 0) return;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            assert(id >= 0 && id < (int)_sections.size());
+            _pending.push_back({id, in, out, len});
+        }
+
+        // filter every queued packet, the packets of one stream in the order they were pushed. Returns the number of packets.
+        inline size_t run(){
+
+            std::lock_guard<std::mutex> run_lock(_run_mutex);
+
+            std::vector<Packet> p;
+            _apply_changes(&p);
+
+            // the packets of one stream next to each other, in the order of arrival
+            std::stable_sort(p.begin(), p.end(), [](const Packet& u, const Packet& v){ return u.id < v.id; });
+
+            // one job per stream, grouped by the number of sections
+            std::map<int,std::vector<Job>> groups;
+            for (size_t i=0;i<p.size();){
+
+                Job job{p[i].id, i, i, 0};
+                for (; i<p.size() && p[i].id == job.id; i++) job.len += p[i].len;
+                job.last = i;
+
+                groups[_n[job.id]].push_back(job);
+            }
+
+            // the longest streams first, so the lengths of the streams in the lanes of a batch are close
+            std::vector<std::tuple<int,size_t,size_t>> batches;
+            for (auto& [n, jobs]: groups){
+
+                std::stable_sort(jobs.begin(), jobs.end(), [](const Job& u, const Job& v){ return u.len > v.len; });
+
+                size_t count = (jobs.size() + M*_per_lane - 1)/(M*_per_lane);
+                for (size_t b=0;b<count;b++) batches.emplace_back(n, b, count);
+            }
+
+            tbb::parallel_for(size_t(0), batches.size(), [&](size_t i){
+                auto [n, b, count] = batches[i];
+                _batch(p, groups.at(n), b, count, n);
+            });
+
+            return p.size();
+        }
+
+        // set the initial conditions [xi1 xi2 yi1 yi2] of every section of stream id from the next run on.
+        inline void set_inits(const int id,const T* inits){
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            assert(id >= 0 && id < (int)_sections.size());
+
+            _changes.push_back([this, id, s = std::vector<T>(inits, inits + 4*_sections[id])](){
+                std::copy(s.begin(), s.end(), &_state[_offset[id]]);
+            });
+        }
+
+        // the current initial conditions [xi1 xi2 yi1 yi2] of every section of stream id, after the queued changes.
+        inline void get_inits(const int id,T* inits){
+
+            std::lock_guard<std::mutex> run_lock(_run_mutex);
+
+            _apply_changes();
+
+            assert(id >= 0 && id < (int)_n.size());
+            std::copy(&_state[_offset[id]], &_state[_offset[id]] + 4*_n[id], inits);
+        }
+
+        // replace the coefficients [b0 b1 b2 a1 a2] of every section of stream id from the next run on, the state is kept.
+        inline void set_coefs(const int id,const T* coefs){
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            assert(id >= 0 && id < (int)_sections.size());
+
+            std::vector<T> c;
+            for (int i=0;i<_sections[id];i++)
+                for (auto q=0; q<4; q++) c.push_back(coefs[5*i+1+q]);
+
+            _changes.push_back([this, id, c = std::move(c)](){
+                std::copy(c.begin(), c.end(), &_coefs[_offset[id]]);
+            });
+        }
+
+        inline int streams(){
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _sections.size();
+        }
+
+        inline size_t pending(){
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _pending.size();
+        }
+
+};
+
+#endif // header guard
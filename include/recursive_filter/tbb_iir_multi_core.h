@@ -5,10 +5,16 @@
 #include <vector>
 #include <cassert>
 #include <utility>
+#include <tuple>
 #include <memory>
+#include <deque>
+#include <algorithm>
+#include <functional>
 
 // Implement IIR filter in a task-oriented system TBB that leverages multi-core processing.
-template<typename V,int N> class TBBIIRMultiCore{ 
+// N denotes the number of cascaded sos, or Dynamic if it is only known at runtime.
+// Every call keeps the state of the sections as the initial conditions of the next call, except filtfilt.
+template<typename V,int N=Dynamic> class TBBIIRMultiCore{ 
 
     using T = decltype(std::declval<V>().extract(0));
     static constexpr int M = V::size();
@@ -17,44 +23,372 @@ template<typename V,int N> class TBBIIRMultiCore{
     
     private:
 
-        std::array<T,N> b1,b2,a1,a2,xi1,xi2,yi1,yi2;
+        // pre-computed tables of sections, each one is shared by all the stages of its section.
+        std::vector<std::shared_ptr<const SectionTable<V>>> tabs;
+
+        // tables of the sections that are first order (b2 = a2 = 0), which run the first order stages, or null.
+        std::vector<std::shared_ptr<const FirstOrderTable<V>>> tabs1;
+
+        // tables of the allpass sections, whose numerator has b0, which run the allpass zic, or null.
+        std::vector<std::shared_ptr<const AllpassTable<V>>> tabsA;
+
+        // the table of the next block of each section if the coefficients vary from block to block, called in the order of
+        // blocks, or empty. The tables of sections are null then.
+        std::vector<std::function<std::shared_ptr<const TileTable<V>>()>> next_tile;
+
+        // the stages of the sections of order P, e.g., merged sections, or null. The tables of sections are null then.
+        std::vector<std::shared_ptr<const HigherOrderStages<V>>> tabsP;
+
+        std::vector<T> xi1,xi2,yi1,yi2;
+
+        // the initial conditions [xi1 ... xiP yi1 ... yiP] of the sections of order P
+        std::vector<std::vector<T>> initsP;
+
+        // the number of initial conditions of section i
+        inline size_t _width(const size_t i) const { return tabsP[i] ? 2*tabsP[i]->order : 4; }
+
+        inline void _first_order(){
+
+            tabsA.resize(tabs.size());
+            tabsP.resize(tabs.size());
+            tabs1.assign(tabs.size(), nullptr);
+            for (size_t i=0;i<tabs.size();i++)
+                if (tabs[i] && !tabsA[i] && is_first_order(tabs[i]->b2, tabs[i]->a2))
+                    tabs1[i] = make_first_order_table<V>(tabs[i]->b1, tabs[i]->a1);
+        };
 
     public:
 
-        // N denotes the number of cascaded sos.
-        TBBIIRMultiCore(const T (&coefs)[N][5],const T (&inits)[N][4]){
+        template<int K> TBBIIRMultiCore(const T (&coefs)[K][5],const T (&inits)[K][4]): TBBIIRMultiCore(&coefs[0][0],&inits[0][0],K){};
+
+        // Overloaded constructor, n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2].
+        TBBIIRMultiCore(const T* coefs,const T* inits,const int n){
+
+            assert(N == Dynamic || n == N);
 
-            for (int i=0;i<N;i++){
+            for (int i=0;i<n;i++)
+                tabs.push_back(make_section_table<V>(coefs + 5*i));
 
-                b1[i] = coefs[i][1];
-                b2[i] = coefs[i][2];
-                a1[i] = coefs[i][3];
-                a2[i] = coefs[i][4];
-                xi1[i] = inits[i][0];
-                xi2[i] = inits[i][1];
-                yi1[i] = inits[i][2];
-                yi2[i] = inits[i][3];
+            _first_order();
+            set_inits(inits);
+        };
+
+        // Overloaded constructor, share the tables of sections that have been computed, e.g., by the single-core filter.
+        TBBIIRMultiCore(const std::vector<std::shared_ptr<const SectionTable<V>>>& tables,const T* inits): tabs(tables){
+
+            _first_order();
+            set_inits(inits);
+        };
+
+        // Overloaded constructor, a cascade of allpass sections, e.g., a phase of a half-band filter.
+        TBBIIRMultiCore(const std::vector<std::shared_ptr<const AllpassTable<V>>>& allpass,const T* inits): tabsA(allpass){
+
+            tabs.assign(allpass.begin(), allpass.end());
+
+            _first_order();
+            set_inits(inits);
+        };
+
+        /*
+            Overloaded constructor, sections of order P, e.g., merged by merge_sections, followed by second order sections. The
+            initial conditions are [xi1 ... xiP yi1 ... yiP] of each section of order P and [xi1 xi2 yi1 yi2] of each sos.
+         */
+        TBBIIRMultiCore(const std::vector<std::shared_ptr<const HigherOrderStages<V>>>& stages,const std::vector<std::shared_ptr<const SectionTable<V>>>& tables,const T* inits): tabsP(stages){
+
+            tabs.assign(stages.size(), nullptr);
+            tabs.insert(tabs.end(), tables.begin(), tables.end());
+
+            _first_order();
+            set_inits(inits);
+        };
+
+        /*
+            Overloaded constructor, n sections whose coefficients vary from block to block (M*M samples), see vary. Every
+            section takes the table of its block in tag order in front of the stateless stages, and the inter block recursive
+            doubling is replaced by a sequential propagation of the two initials since C^M changes with every block.
+         */
+        TBBIIRMultiCore(const int n,const T* inits): tabs(n){
+
+            _first_order();
+            set_inits(inits);
+        };
+
+        inline void set_inits(const T* inits){
+
+            xi1.resize(tabs.size());
+            xi2.resize(tabs.size());
+            yi1.resize(tabs.size());
+            yi2.resize(tabs.size());
+            initsP.resize(tabs.size());
+
+            for (size_t i=0;i<tabs.size();inits+=_width(i),i++){
+
+                if (tabsP[i]){
+
+                    initsP[i].assign(inits, inits + _width(i));
+                    continue;
+                }
+
+                xi1[i] = inits[0];
+                xi2[i] = inits[1];
+                yi1[i] = inits[2];
+                yi2[i] = inits[3];
             }
         };
 
-    inline std::pair<std::vector<T>,std::vector<T>> operator()(std::vector<T> in_data){
+        // replace the tables of sections, e.g., new coefficients. The graph of a running call keeps the tables it was built with.
+        inline void set_tables(const std::vector<std::shared_ptr<const SectionTable<V>>>& tables){
 
-        // the input data to multi-core iir filter must be a multiple of M*M
-        assert(in_data.size()%L == 0);
+            assert(tables.size() == tabs.size());
+            tabs = tables;
+            tabsA.assign(tabs.size(), nullptr);
+            tabsP.assign(tabs.size(), nullptr);
+            next_tile.clear();
+            _first_order();
+        };
 
-        size_t block_max = in_data.size()/L;
+    // the nodes of the sections of the cascade in a graph, they live as long as the graph runs.
+    struct Chain{
+
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> init_adder;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> zic;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> rd;
+        std::vector<std::unique_ptr<tbb::flow::sequencer_node<DataBlock<V>>>> seq_for_init,seq_for_buffer;
+        std::vector<std::unique_ptr<Buffer<V>>> buffer_node;
+        std::vector<std::unique_ptr<tbb::flow::multifunction_node<std::vector<DataBlock<V>>,std::tuple<DataBlock<V>>>>> inter_block_rd;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> inter_block_seq;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> forward;
+    };
+
+    /*
+        build the nodes of the sections behind the node prev_node that sends the transposed blocks, e.g., the same loaded blocks
+        can be sent to the cascades of a filter bank. U > 1 if the blocks are zero-stuffed by U. Returns the node that sends the
+        filtered blocks.
+     */
+    inline tbb::flow::sender<DataBlock<V>>* build_chain(tbb::flow::graph& g,tbb::flow::sender<DataBlock<V>>* prev_node,Chain& c,const int U=1){
+
+        // note: the node of TBB flow graph is a very high-level construction, it is super hard to design nested function nodes for series as single core.
+        for (size_t i=0;i<tabs.size();i++){
+
+            // a section of order P has its own stages in the same places, its initial conditions go with the stateful ones
+            if (tabsP[i]){
+
+                const HigherOrderStages<V>& s = *tabsP[i];
+
+                c.seq_for_init.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
+                    g,[](const DataBlock<V> &v) -> size_t{
+                    return v.tag;}));
+                c.seq_for_buffer.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
+                    g,[](const DataBlock<V> &v) -> size_t{
+                    return v.tag;}));
+
+                c.init_adder.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(g,tbb::flow::serial,s.init_adder(initsP[i].data())));
+                c.zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(g,tbb::flow::unlimited,s.zic));
+                c.rd.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(g,tbb::flow::unlimited,s.rd));
+                c.buffer_node.push_back(std::make_unique<Buffer<V>>(g,M));
+                c.inter_block_rd.push_back(s.inter_block(g,initsP[i].data() + s.order));
+                c.forward.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(g,tbb::flow::unlimited,s.forward));
+
+                tbb::flow::make_edge(*prev_node,*c.seq_for_init.back());
+                tbb::flow::make_edge(*c.seq_for_init.back(),*c.init_adder.back());
+                tbb::flow::make_edge(*c.init_adder.back(),*c.zic.back());
+                tbb::flow::make_edge(*c.zic.back(),*c.rd.back());
+                tbb::flow::make_edge(*c.rd.back(),*c.seq_for_buffer.back());
+                tbb::flow::make_edge(*c.seq_for_buffer.back(),*c.buffer_node.back());
+                tbb::flow::make_edge(tbb::flow::output_port<0>(*c.buffer_node.back()),*c.inter_block_rd.back());
+                tbb::flow::make_edge(tbb::flow::output_port<0>(*c.inter_block_rd.back()),*c.forward.back());
+
+                prev_node = c.forward.back().get();
+                continue;
+            }
+
+            const bool varying = !next_tile.empty();
+
+            // an all-pole section does not read the initial conditions of inputs, so its blocks go to zic in any order
+            bool all_pole = !varying && !tabs1[i] && !tabsA[i] && tabs[i]->zeros == Zeros::all_pole;
+
+            if (!all_pole){
+
+                c.seq_for_init.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
+                    g,[](const DataBlock<V> &v) -> size_t{
+                    return v.tag;}));
+
+                // the table of each block is attached in tag order, and travels with the block through the stateless stages
+                if (varying)
+                    c.init_adder.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                        g,tbb::flow::serial,[adder = InitAdder<V>{xi1[i],xi2[i]}, next = next_tile[i]](DataBlock<V> v) mutable -> DataBlock<V>{
+                        v = adder(v);
+                        v.tile = next();
+                        return v;}));
+                else
+                    c.init_adder.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                        g,tbb::flow::serial,InitAdder<V>{xi1[i],xi2[i]}));
+            }
+
+            c.seq_for_buffer.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
+                g,[](const DataBlock<V> &v) -> size_t{
+                return v.tag;}));
+
+            if (varying){
+
+                // as for fixed coefficients, the zero rows are skipped only if U divides M
+                const unsigned rows = NoStateZIC<V>::rows_of((i == 0 && U > 1 && M%U == 0) ? U : 1);
+
+                c.zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,[rows](DataBlock<V> v) -> DataBlock<V>{
+                    NoStateZIC<V>::kernel(*v.tile, v, rows);
+                    return v;}));
+
+                c.rd.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,[](DataBlock<V> v) -> DataBlock<V>{
+                    RecurDoubV<V>::kernel(*v.tile, v);
+                    return v;}));
+
+                c.inter_block_seq.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::serial,InterBlockSeq<V>{yi1[i],yi2[i]}));
+
+                c.forward.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,[](DataBlock<V> v) -> DataBlock<V>{
+                    ICCForward<V>::kernel(*v.tile, v);
+                    return v;}));
+
+                tbb::flow::make_edge(*prev_node,*c.seq_for_init.back());
+                tbb::flow::make_edge(*c.seq_for_init.back(),*c.init_adder.back());
+                tbb::flow::make_edge(*c.init_adder.back(),*c.zic.back());
+                tbb::flow::make_edge(*c.zic.back(),*c.rd.back());
+                tbb::flow::make_edge(*c.rd.back(),*c.seq_for_buffer.back());
+                tbb::flow::make_edge(*c.seq_for_buffer.back(),*c.inter_block_seq.back());
+                tbb::flow::make_edge(*c.inter_block_seq.back(),*c.forward.back());
+
+                prev_node = c.forward.back().get();
+                continue;
+            }
+
+            c.buffer_node.push_back(std::make_unique<Buffer<V>>(g,M));
+
+            // a first order section has its own stages in the same places
+            if (tabs1[i]){
+
+                c.zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,NoStateZICOrderOne<V>{tabs1[i]}));
+
+                c.rd.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,RecurDoubVOrderOne<V>{tabs1[i]}));
+
+                c.inter_block_rd.push_back(std::make_unique<InterBlockRDOrderOne<V>>(g,tabs1[i],yi1[i]));
+
+                c.forward.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,ICCForwardOrderOne<V>{tabs1[i]}));
+
+            } else {
+
+                // only the first section sees the zeros, its rows are either real samples or zeros if U divides M
+                const int stuffed = (i == 0 && U > 1 && M%U == 0) ? U : 1;
+
+                // an allpass section has the homogeneous part of any section with its poles, only its zic differs
+                if (tabsA[i])
+                    c.zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                        g,tbb::flow::unlimited,NoStateZICAllpass<V>{tabsA[i]}));
+                else
+                    c.zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                        g,tbb::flow::unlimited,NoStateZIC<V>{tabs[i],stuffed}));
+
+                c.rd.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,RecurDoubV<V>{tabs[i]}));
+
+                c.inter_block_rd.push_back(std::make_unique<InterBlockRD<V>>(g,tabs[i],yi1[i],yi2[i]));
+
+                c.forward.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
+                    g,tbb::flow::unlimited,ICCForward<V>{tabs[i]}));
+            }
+            
+            if (all_pole){
+
+                tbb::flow::make_edge(*prev_node,*c.zic.back());
+
+            } else {
+
+                tbb::flow::make_edge(*prev_node,*c.seq_for_init.back());
+                tbb::flow::make_edge(*c.seq_for_init.back(),*c.init_adder.back());
+                tbb::flow::make_edge(*c.init_adder.back(),*c.zic.back());
+            }
+
+            tbb::flow::make_edge(*c.zic.back(),*c.rd.back());
+            tbb::flow::make_edge(*c.rd.back(),*c.seq_for_buffer.back());
+            tbb::flow::make_edge(*c.seq_for_buffer.back(),*c.buffer_node.back());
+            tbb::flow::make_edge(tbb::flow::output_port<0>(*c.buffer_node.back()),*c.inter_block_rd.back());
+            tbb::flow::make_edge(tbb::flow::output_port<0>(*c.inter_block_rd.back()),*c.forward.back());
+
+            prev_node = c.forward.back().get();
 
-        // pre-process input data to transfer type from T to arrayV
-        std::vector<arrayV> x;
-        for (int i = 0; i < block_max; i++){
-            arrayV tmp;
-            for (auto n = 0; n < M; n++)
-                tmp[n].load(&in_data[n*M+i*L]);
-            x.push_back(tmp);
         }
 
+        return prev_node;
+    }
+
+    /*
+        the coefficients of each section vary from block to block: next[i]() gives the table of the next block of section i, it
+        is called once per block in the order of blocks while a call runs. set_tables goes back to fixed coefficients.
+     */
+    inline void vary(std::vector<std::function<std::shared_ptr<const TileTable<V>>()>> next){
+
+        assert(next.size() == tabs.size());
+        next_tile = std::move(next);
+    }
+
+    // keep the state of each section for the next call, post_inits: xi2, xi1, yi2, yi1 per sos, xi1 ... xiP, yi1 ... yiP per section of order P.
+    inline void keep_state(const std::vector<T>& post_inits){
+
+        // a call of no blocks has no state to keep
+        if (post_inits.empty()) return;
+
+        assert(post_inits.size() == width());
+
+        const T* p = post_inits.data();
+        for (size_t i=0;i<tabs.size();p+=_width(i),i++){
+
+            if (tabsP[i]){
+
+                initsP[i].assign(p, p + _width(i));
+                continue;
+            }
+
+            xi2[i] = p[0];
+            xi1[i] = p[1];
+            yi2[i] = p[2];
+            yi1[i] = p[3];
+        }
+    }
+
+    // the number of initial conditions of the cascade, 4 per sos and 2P per section of order P.
+    inline size_t width() const {
+
+        size_t w = 0;
+        for (size_t i=0;i<tabs.size();i++) w += _width(i);
+
+        return w;
+    }
+
+    inline size_t size() const { return tabs.size(); }
+
+    private:
+
+    // the nodes behind the loading of a graph, they are destroyed before the graph.
+    struct Nodes{
+
+        std::deque<Chain> chains;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> bridge;
+        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>>>> sink;
+    };
+
+    /*
+        the graph over block_max blocks: the source of tags and the loading of each block by load(tag, data), which fills the
+        transposed samples of the block in parallel and in any order of blocks. build(g, prev_node, nodes) builds the rest
+        behind the loading in nodes.
+     */
+    template<typename Load,typename Build> static inline void _graph(const size_t block_max,Load load,Build build){
+
         size_t n_block = 0;
-        std::vector<T> output,post_inits;
 
         tbb::flow::graph g;
 
@@ -63,8 +397,6 @@ template<typename V,int N> class TBBIIRMultiCore{
         [&](DataBlock<V> &in_block)-> bool{
             if (n_block < block_max){
 
-                in_block.data = x[n_block];
-                in_block.ori_data = x[n_block];
                 in_block.tag = n_block;
                 n_block++;
                 // attach the last flag if the last data block in input data is sent out
@@ -75,92 +407,249 @@ template<typename V,int N> class TBBIIRMultiCore{
 
         tbb::flow::function_node<DataBlock<V>,DataBlock<V>> prior_permute(g,tbb::flow::unlimited,
         [&](DataBlock<V> v) -> DataBlock<V>{
-            v.data = _permuteV(v.data);
+            load(v.tag, v.data);
             return v;
         });
 
-        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> init_adder;
-        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> zic;
-        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> rd;
-        std::vector<std::unique_ptr<tbb::flow::sequencer_node<DataBlock<V>>>> seq_for_init,seq_for_buffer;
-        std::vector<std::unique_ptr<Buffer<V>>> buffer_node;
-        std::vector<std::unique_ptr<InterBlockRD<V>>> inter_block_rd;
-        std::vector<std::unique_ptr<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>> forward;
+        Nodes nodes;
+        build(g, &prior_permute, nodes);
 
-        tbb::flow::sender<DataBlock<V>> *prev_node = &prior_permute;
+        tbb::flow::make_edge(my_src,prior_permute);
 
-        // note: the node of TBB flow graph is a very high-level construction, it is super hard to design nested function nodes for series as single core.
-        for (int i=0;i<N;i++){
+        my_src.activate();
+        g.wait_for_all();
+    }
 
-            seq_for_init.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
-                g,[](const DataBlock<V> &v) -> size_t{
-                return v.tag;}));
+    /*
+        run the graph over block_max blocks. load(tag, data) fills the transposed samples of a block, store(tag, data) takes the
+        filtered block in the transposed domain, both run in parallel and in any order of blocks. U > 1 if the loaded blocks are
+        zero-stuffed by U. If a bridge is given, the filtered blocks go through it to a second pass of the cascade in the same
+        graph, e.g., the backward pass of filtfilt. The state is kept for the next call, returns the post_inits of the last pass.
+     */
+    template<typename Load,typename Store,typename Bridge=std::nullptr_t>
+    inline std::vector<T> _run(const size_t block_max,Load load,Store store,const int U=1,Bridge bridge=nullptr){
 
-            init_adder.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
-                g,tbb::flow::serial,InitAdder<V>{xi1[i],xi2[i]}));
+        std::vector<T> post_inits;
 
-            zic.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
-                g,tbb::flow::unlimited,NoStateZIC<V>{b1[i],b2[i],a1[i],a2[i],xi1[i],xi2[i]}));
+        _graph(block_max, load, [&](tbb::flow::graph& g, tbb::flow::sender<DataBlock<V>>* prev_node, Nodes& nodes){
 
-            rd.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
-                g,tbb::flow::unlimited,RecurDoubV<V>{a1[i],a2[i]}));
+            prev_node = build_chain(g,prev_node,nodes.chains.emplace_back(),U);
 
-            seq_for_buffer.push_back(std::make_unique<tbb::flow::sequencer_node<DataBlock<V>>>(
-                g,[](const DataBlock<V> &v) -> size_t{
-                return v.tag;}));
+            if constexpr (!std::is_same<Bridge,std::nullptr_t>::value){
 
-            buffer_node.push_back(std::make_unique<Buffer<V>>(g,M));
+                nodes.bridge.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(g,tbb::flow::unlimited,bridge));
 
-            inter_block_rd.push_back(std::make_unique<InterBlockRD<V>>(g,a1[i],a2[i],yi1[i],yi2[i]));
+                tbb::flow::make_edge(*prev_node,*nodes.bridge.back());
+                prev_node = build_chain(g,nodes.bridge.back().get(),nodes.chains.emplace_back());
+            }
 
-            forward.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>,DataBlock<V>>>(
-                g,tbb::flow::unlimited,ICCForward<V>{a1[i],a2[i]}));
-            
-            tbb::flow::make_edge(*prev_node,*seq_for_init.back());
-            tbb::flow::make_edge(*seq_for_init.back(),*init_adder.back());
-            tbb::flow::make_edge(*init_adder.back(),*zic.back());
-            tbb::flow::make_edge(*zic.back(),*rd.back());
-            tbb::flow::make_edge(*rd.back(),*seq_for_buffer.back());
-            tbb::flow::make_edge(*seq_for_buffer.back(),*buffer_node.back());
-            tbb::flow::make_edge(tbb::flow::output_port<0>(*buffer_node.back()),*inter_block_rd.back());
-            tbb::flow::make_edge(tbb::flow::output_port<0>(*inter_block_rd.back()),*forward.back());
+            // each block is stored at its own position, so the blocks do not need to be put in order again.
+            nodes.sink.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>>>(g,tbb::flow::unlimited,[&](DataBlock<V> out){
 
-            prev_node = forward.back().get();
+                store(out.tag, out.data);
 
-        }
+                if (out.last)
+                    post_inits = out.post_inits;
+            }));
 
-        tbb::flow::function_node<DataBlock<V>,DataBlock<V>> post_permute(g,tbb::flow::serial,
-        [&](DataBlock<V> v) -> DataBlock<V>{
-            v.data = _permuteV(v.data);
-            return v;
+            tbb::flow::make_edge(*prev_node,*nodes.sink.back());
         });
 
-        tbb::flow::sequencer_node<DataBlock<V>> seq_for_sink(g,
-            [](const DataBlock<V> &v) -> size_t{
-            return v.tag;
-        });
+        keep_state(post_inits);
+
+        return post_inits;
+    }
+
+    public:
+
+    /*
+        run the cascades mc over the same blocks in one graph, e.g., a filter bank: each block is loaded by load(tag, data) and
+        transposed once and sent to the sections of every cascade. store(k, tag, data) takes the filtered block of cascade k in
+        the transposed domain, in parallel and in any order of blocks and cascades. The state of every cascade is kept for the
+        next call, returns the post_inits of each one.
+     */
+    template<typename Load,typename Store>
+    static inline std::vector<std::vector<T>> run_shared(std::vector<TBBIIRMultiCore>& mc,const size_t block_max,Load load,Store store){
+
+        std::vector<std::vector<T>> post_inits(mc.size());
+
+        _graph(block_max, load, [&](tbb::flow::graph& g, tbb::flow::sender<DataBlock<V>>* prior, Nodes& nodes){
+
+            for (size_t k=0;k<mc.size();k++){
 
-        tbb::flow::function_node<DataBlock<V>> sink(g,tbb::flow::serial,[&](DataBlock<V> out){
+                tbb::flow::sender<DataBlock<V>> *prev_node = mc[k].build_chain(g,prior,nodes.chains.emplace_back());
 
-            std::array<T,L> result;
-            for (auto n=0; n<M; n++) out.data[n].store(&result[n*M]);
-            output.insert(output.end(),result.begin(),result.end());
+                nodes.sink.push_back(std::make_unique<tbb::flow::function_node<DataBlock<V>>>(g,tbb::flow::unlimited,[&,k](DataBlock<V> out){
 
-            if (out.last)
-                post_inits = out.post_inits;
+                    if (out.last)
+                        post_inits[k] = out.post_inits;
 
+                    store(k, out.tag, out.data);
+                }));
+
+                tbb::flow::make_edge(*prev_node,*nodes.sink.back());
+            }
         });
 
-        tbb::flow::make_edge(my_src,prior_permute);
-        tbb::flow::make_edge(*prev_node,post_permute);
-        tbb::flow::make_edge(post_permute, seq_for_sink);
-        tbb::flow::make_edge(seq_for_sink, sink);
+        for (size_t k=0;k<mc.size();k++)
+            mc[k].keep_state(post_inits[k]);
 
-        my_src.activate();
-        g.wait_for_all();
+        return post_inits;
+    }
+
+    public:
+
+    inline std::pair<std::vector<T>,std::vector<T>> operator()(std::vector<T> in_data){
+
+        // the input data to multi-core iir filter must be a multiple of M*M
+        assert(in_data.size()%L == 0);
+
+        std::vector<T> output(in_data.size());
+
+        auto post_inits = _run(in_data.size()/L,
+            [&](size_t tag, arrayV& data){
+                for (auto n = 0; n < M; n++)
+                    data[n].load(&in_data[n*M+tag*L]);
+                data = _permuteV(data);
+            },
+            [&](size_t tag, arrayV& data){
+                data = _permuteV(data);
+                for (auto n = 0; n < M; n++)
+                    data[n].store(&output[n*M+tag*L]);
+            });
+
+        return std::make_pair(output,post_inits);
+
+    }
+
+    /*
+        fused decimation: filter the input and keep only the samples at offset, offset + D, offset + 2D, ... of in_data. The kept
+        samples are taken straight from the transposed blocks in the sink, so the filtered blocks are neither transposed back nor
+        stored, and the output is D times smaller.
+     */
+    inline std::pair<std::vector<T>,std::vector<T>> decimate(const std::vector<T>& in_data,const size_t D,const size_t offset=0){
+
+        // the input data to multi-core iir filter must be a multiple of M*M
+        assert(in_data.size()%L == 0);
+        assert(D > 0 && offset < D);
+
+        std::vector<T> output((in_data.size() > offset) ? (in_data.size() - offset + D - 1)/D : 0);
+
+        auto post_inits = _run(in_data.size()/L,
+            [&](size_t tag, arrayV& data){
+                for (auto n = 0; n < M; n++)
+                    data[n].load(&in_data[n*M+tag*L]);
+                data = _permuteV(data);
+            },
+            [&](size_t tag, arrayV& data){
+
+                // the first kept sample in the block, the sample s of the block is the lane s/M of data[s%M]
+                size_t k = (tag*L <= offset) ? offset : offset + (tag*L - offset + D - 1)/D*D;
+                for (; k < (tag+1)*L; k += D){
+
+                    size_t s = k - tag*L;
+                    output[(k-offset)/D] = data[s%M][s/M];
+                }
+            });
 
         return std::make_pair(output,post_inits);
+    }
+
+    /*
+        interpolation by U: filter the input zero-stuffed by U, i.e., U-1 zeros after each sample, without building the stuffed
+        signal. The blocks are loaded straight into the transposed domain, and if U divides M the first section only multiplies
+        the rows of real samples. The output of U*in_data.size() samples is the one of the explicitly stuffed signal.
+     */
+    inline std::pair<std::vector<T>,std::vector<T>> interpolate(const std::vector<T>& in_data,const size_t U){
+
+        // the stuffed data to multi-core iir filter must be a multiple of M*M
+        assert(U > 0 && in_data.size()*U%L == 0);
+
+        std::vector<T> output(in_data.size()*U);
+
+        auto post_inits = _run(output.size()/L,
+            [&](size_t tag, arrayV& data){
+
+                // the sample s of the block is the lane s/M of data[s%M]
+                std::array<T,M> row;
+                for (auto k = 0; k < M; k++){
+
+                    for (auto j = 0; j < M; j++){
+
+                        size_t g = tag*L + j*M + k;
+                        row[j] = (g%U == 0) ? in_data[g/U] : T(0);
+                    }
 
+                    data[k].load(row.data());
+                }
+            },
+            [&](size_t tag, arrayV& data){
+                data = _permuteV(data);
+                for (auto n = 0; n < M; n++)
+                    data[n].store(&output[n*M+tag*L]);
+            },
+            int(U));
+
+        return std::make_pair(output,post_inits);
+    }
+
+    /*
+        zero-phase filtering: a forward pass from inits, or from the steady state of the first sample by default, and a backward
+        pass over the output of the forward pass from the steady state of the last sample of the forward pass. Both passes run
+        in one graph: the blocks of the forward pass go to the backward pass in reverse order of blocks and of samples within a
+        block as soon as they are filtered, so the samples are never copied in reverse order, and the initial conditions of the
+        backward pass go with its first block. The stored initial conditions are not changed. Returns the output and the
+        post_inits of the backward pass.
+     */
+    inline std::pair<std::vector<T>,std::vector<T>> filtfilt(const std::vector<T>& in_data,const T* inits=nullptr){
+
+        // the input data to multi-core iir filter must be a multiple of M*M
+        assert(in_data.size()%L == 0);
+
+        size_t block_max = in_data.size()/L;
+        if (block_max == 0) return {};
+
+        // the steady state is only known for second order sections of fixed coefficients, not for allpass or merged ones
+        assert(next_tile.empty());
+        assert(std::all_of(tabs.begin(), tabs.end(), [](const auto& t){ return bool(t); }));
+        assert(std::none_of(tabsA.begin(), tabsA.end(), [](const auto& t){ return bool(t); }));
+        assert(std::none_of(tabsP.begin(), tabsP.end(), [](const auto& s){ return bool(s); }));
+
+        std::vector<T> output(in_data.size());
+
+        // the graph takes the initial conditions of the forward pass when it is built, the stored ones are put back after
+        auto stored = std::make_tuple(xi1, xi2, yi1, yi2);
+        set_inits(inits ? inits : steady_inits(tabs, in_data[0]).data());
+
+        auto post_inits = _run(block_max,
+            [&](size_t tag, arrayV& data){
+                for (auto n = 0; n < M; n++)
+                    data[n].load(&in_data[n*M+tag*L]);
+                data = _permuteV(data);
+            },
+            [&](size_t tag, arrayV& data){
+                data = _permuteV(_reverseV(data));
+                for (auto n = 0; n < M; n++)
+                    data[n].store(&output[n*M+(block_max-1-tag)*L]);
+            },
+            1,
+            [&](DataBlock<V> v) -> DataBlock<V>{
+
+                v.data = _reverseV(v.data);
+                v.tag = block_max-1-v.tag;
+                v.last = (v.tag == block_max-1);
+                v.post_inits.clear();
+
+                // the first sample of the backward pass is the last sample of the forward pass
+                if (v.tag == 0)
+                    v.pre_inits = steady_inits(tabs, v.data[0][0]);
+
+                return v;
+            });
+
+        std::tie(xi1, xi2, yi1, yi2) = std::move(stored);
+
+        return std::make_pair(output,post_inits);
     }
 
 };
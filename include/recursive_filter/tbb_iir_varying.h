@@ -0,0 +1,108 @@
+#ifndef TBB_IIR_VARYING_H
+#define TBB_IIR_VARYING_H 1
+
+#include <array>
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <memory>
+#include <functional>
+#include <tbb/tbb.h>
+#include "coef_control.h"
+
+/*
+    Implement IIR filter whose coefficients vary from block to block (M*M samples) in TBB. The graph is the one of
+    TBBIIRMultiCore in its varying mode: the tables of all blocks are made in parallel before the graph runs, a table only
+    where the coefficients change, and the serial init adder of each section only attaches them in tag order. The inter block
+    recursive doubling is replaced by a sequential propagation of the two initials over blocks since the transition matrix C^M
+    changes with every block, which costs 8 multiplications per block.
+ */
+template<typename V> class TBBIIRVarying{
+
+    using T = decltype(std::declval<V>().extract(0));
+    using Tiles = std::vector<std::shared_ptr<const TileTable<V>>>;
+    static constexpr int L = V::size()*V::size();
+
+    private:
+
+        TBBIIRMultiCore<V> _MC;
+
+        // the table of the last block of each section, reused by the next call as long as the coefficients do not change
+        Tiles _last;
+
+    public:
+
+        // initial conditions [xi1 xi2 yi1 yi2] of n sections.
+        TBBIIRVarying(const T* inits,const int n): _MC(n,inits),_last(n){};
+
+        inline void set_inits(const T* inits){ _MC.set_inits(inits); };
+
+    // filter the blocks with the coefficients given block by block by the control of each section.
+    inline std::pair<std::vector<T>,std::vector<T>> operator()(std::vector<T> in_data,std::vector<CoefControl<T>>& ctrl){
+
+        // the input data to multi-core iir filter must be a multiple of M*M
+        assert(in_data.size()%L == 0);
+        assert(ctrl.size() == _MC.size());
+
+        const size_t n = ctrl.size(), blocks = in_data.size()/L;
+
+        // the coefficients of every block in order: a table is only made where they change, the blocks in between share it,
+        // and the first blocks share the table of the last call. use: 1 + the index of the table of each block, 0 for the last.
+        std::vector<std::array<T,4>> coefs;
+        std::vector<std::vector<size_t>> use(n, std::vector<size_t>(blocks));
+
+        for (size_t i=0;i<n;i++){
+
+            const TileTable<V>* t = _last[i].get();
+            std::array<T,4> prev = t ? std::array<T,4>{t->b1, t->b2, t->a1, t->a2} : std::array<T,4>{};
+            bool fresh = !t;
+            size_t u = 0;
+
+            for (size_t k=0;k<blocks;k++){
+
+                auto c = ctrl[i].next();
+
+                if (fresh || c != prev){
+
+                    coefs.push_back(c);
+                    u = coefs.size();
+                    prev = c;
+                    fresh = false;
+                }
+
+                use[i][k] = u;
+            }
+        }
+
+        // the tables are independent, O(M) each, so they are made in parallel instead of on the serial init adders.
+        Tiles made(coefs.size());
+
+        tbb::parallel_for(size_t(0), coefs.size(), [&](size_t j){
+            made[j] = make_tile_table<V>(coefs[j][0], coefs[j][1], coefs[j][2], coefs[j][3]);
+        });
+
+        // the graph owns the tables of each section, nothing refers to ctrl once the call returns.
+        std::vector<std::function<std::shared_ptr<const TileTable<V>>()>> next;
+
+        for (size_t i=0;i<n;i++){
+
+            auto list = std::make_shared<Tiles>(blocks);
+            for (size_t k=0;k<blocks;k++) (*list)[k] = use[i][k] ? made[use[i][k]-1] : _last[i];
+
+            if (blocks > 0) _last[i] = list->back();
+
+            // every block takes its table out of the list, so the tables are released as the blocks pass.
+            next.push_back([list, k = size_t(0)]() mutable {
+                assert(k < list->size());
+                return std::move((*list)[k++]);
+            });
+        }
+
+        _MC.vary(std::move(next));
+
+        return _MC(std::move(in_data));
+    }
+
+};
+
+#endif // header guard
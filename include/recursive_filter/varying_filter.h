@@ -0,0 +1,173 @@
+#ifndef VARYING_FILTER_H
+#define VARYING_FILTER_H 1
+
+#include "tbb_iir_varying.h"
+#include "coef_control.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include "simd_vec.h"
+
+/*
+    real function to user: cascaded second order filter whose coefficients vary over time. The stream is cut into blocks
+    of M*M samples, each block is filtered by its own coefficients interpolated from the control points of the stream.
+    Whole blocks go multi-core, a block that is split over calls is filtered sample by sample by the coefficients of its
+    table.
+ */
+template<typename T> class VaryingFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+
+    private:
+
+        // number of cascaded sos
+        int _n;
+
+        // control of the coefficients of each section
+        std::vector<CoefControl<T>> _ctrl;
+
+        // multi-core filter
+        TBBIIRVarying<V> _MC;
+
+        // the tables of the current block that is split over calls, and the state [xi1 xi2 yi1 yi2] of every section
+        std::vector<std::shared_ptr<const TileTable<V>>> _tiles;
+        std::vector<T> _state;
+
+        // position of the next sample in the stream
+        size_t _pos = 0;
+
+        // control points that have not been handed to the controls yet: the sample position and the coefficients of all sections
+        std::deque<std::pair<size_t,std::vector<T>>> _points;
+        std::unique_ptr<std::mutex> _mutex = std::make_unique<std::mutex>();
+
+        // hand the scheduled control points to the control of each section.
+        inline void _apply_points(){
+
+            std::lock_guard<std::mutex> lock(*_mutex);
+
+            for (auto& p: _points)
+                for (int i=0;i<_n;i++)
+                    _ctrl[i].point(p.first/L, p.second.data() + 5*i);
+
+            _points.clear();
+        }
+
+        // start a block that is filtered sample by sample, a table per block is cheap to make, O(M).
+        inline void _next_tile(){
+
+            for (int i=0;i<_n;i++){
+
+                auto c = _ctrl[i].next();
+                _tiles[i] = make_tile_table<V>(c[0], c[1], c[2], c[3]);
+            }
+        }
+
+        // filter less than a block of samples by the tables of the current block.
+        template<typename InputIt,typename OutputIt> inline OutputIt _serial(InputIt first,InputIt last,OutputIt d_first){
+
+            for (; first != last; first++, d_first++){
+
+                T u = *first;
+                for (int i=0;i<_n;i++){
+
+                    const TileTable<V>& t = *_tiles[i];
+                    T* s = &_state[4*i];
+
+                    T y = u + t.b1*s[0] + t.b2*s[1] + t.a1*s[2] + t.a2*s[3];
+
+                    s[1] = s[0];
+                    s[0] = u;
+                    s[3] = s[2];
+                    s[2] = y;
+                    u = y;
+                }
+
+                *d_first = u;
+            }
+
+            return d_first;
+        }
+
+    public:
+
+        template<int K> VaryingFilter(const T (&coefs)[K][5],const T (&inits)[K][4],const Interp mode=Interp::linear,const T tau=1): VaryingFilter(&coefs[0][0],&inits[0][0],K,mode,tau){}
+
+        // n sections of contiguous coefficients [b0 b1 b2 a1 a2] and initial conditions [xi1 xi2 yi1 yi2], tau in blocks for the exponential move.
+        VaryingFilter(const T* coefs,const T* inits,const int n,const Interp mode=Interp::linear,const T tau=1): _n(n),_MC(inits,n),_tiles(n),_state(inits,inits + 4*n){
+
+            for (int i=0;i<n;i++)
+                _ctrl.emplace_back(coefs + 5*i, mode, tau);
+        }
+
+    template<typename InputIt,typename OutputIt> inline OutputIt operator()(InputIt first,InputIt last,OutputIt d_first){
+
+        _apply_points();
+
+        size_t len = std::distance(first,last);
+
+        // finish the block that the last call has started.
+        if (_pos % L != 0){
+
+            size_t d = std::min(len, L - _pos % L);
+            d_first = _serial(first,first+d,d_first);
+
+            first += d;
+            _pos += d;
+            len -= d;
+        }
+
+        // whole blocks go multi-core, the state is handed over from and back to the samples of split blocks.
+        if (len >= L){
+
+            _MC.set_inits(_state.data());
+
+            auto d = len/L*L;
+            std::vector<T> input(first,first+d);
+            auto output = _MC(input,_ctrl); // std::pair(results,post_inits)
+
+            d_first = std::copy(output.first.begin(), output.first.end(), d_first);
+
+            // post_inits: xi2, xi1, yi2, yi1 per section
+            for (int i=0;i<_n;i++)
+                for (auto q=0; q<4; q++) _state[4*i+q] = output.second[4*i+(q^1)];
+
+            first += d;
+            _pos += d;
+            len -= d;
+        }
+
+        // start a new block that the next call finishes.
+        if (len > 0){
+
+            _next_tile();
+            d_first = _serial(first,last,d_first);
+            _pos += len;
+        }
+
+        return d_first;
+    }
+
+    /*
+        schedule a control point [b0 b1 b2 a1 a2] of all sections at the sample position `at` of the stream, which is reached by
+        the block containing `at`. The point is taken by the next call, a block that has been started meanwhile is not changed.
+     */
+    inline void control(const T* coefs,const size_t at){
+
+        std::lock_guard<std::mutex> lock(*_mutex);
+        _points.emplace_back(at, std::vector<T>(coefs, coefs + 5*_n));
+    }
+
+    template<int K> inline void control(const T (&coefs)[K][5],const size_t at){
+        control(&coefs[0][0],at);
+    }
+
+    // the number of samples filtered since construction, i.e., the position of the next sample in the stream.
+    inline size_t position() const { return _pos; }
+};
+
+#endif // header guard
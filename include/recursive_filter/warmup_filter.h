@@ -0,0 +1,168 @@
+#ifndef WARMUP_FILTER_H
+#define WARMUP_FILTER_H 1
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <tbb/tbb.h>
+#include "runtime_series.h"
+#include "zero_gap.h"
+#include "simd_vec.h"
+
+/*
+    the length of the warm-up of a stable cascade, after which the response to its state is below tol relative to the largest
+    output, i.e., the tail of the impulse response from W on is below tol times its L1 norm. The impulse response is computed
+    in double until it has decayed as the largest pole radius implies, so that repeated poles and slowly decaying modes count.
+ */
+template<typename T> inline size_t warmup_length(const T* coefs, const int n, const double tol) {
+
+    const double r = pole_radius(coefs, n);
+    assert(r < 1 && tol > 0);
+
+    // without poles the state is the last 2 inputs of each section
+    if (r == 0) return 2*n;
+
+    // the estimate of a single pole, and the horizon where the impulse response is computed
+    size_t W0 = std::ceil(std::log(tol)/std::log(r));
+    size_t H = 4*W0 + 8*n + 64;
+
+    std::vector<double> h(H, 0.0);
+    h[0] = 1;
+
+    for (int i=0; i<n; i++){
+
+        const T* c = coefs + 5*i;
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+
+        for (auto& v: h){
+
+            double y = v + c[1]*x1 + c[2]*x2 + c[3]*y1 + c[4]*y2;
+            x2 = x1; x1 = v; y2 = y1; y1 = y;
+            v = y;
+        }
+    }
+
+    // the tail beyond the horizon decays by r at least
+    double tail = std::abs(h[H-1])*r/(1 - r), norm = tail;
+    for (auto v: h) norm += std::abs(v);
+
+    size_t W = H;
+    while (W > 0 && tail + std::abs(h[W-1]) <= tol*norm) tail += std::abs(h[--W]);
+
+    return W;
+};
+
+/*
+    real function to user: approximate multi-core filtering of a stable cascade by independent chunks. Each chunk starts from
+    zero state the warm-up length before its first sample, so the chunks run fully in parallel without any recursive doubling
+    between blocks, and the outputs differ from the exact ones by tol relative to the largest output. The first chunk of a call
+    continues from the state of the stream and is exact, and the state after the last chunk is kept for the next call.
+ */
+template<typename T> class WarmupFilter{
+
+    // select the vector length and type based on the requested instruction set and the type T
+    using V = SimdVec<T>;
+
+    constexpr static int M = V::size();
+    constexpr static int L = M*M;
+
+    using Tables_t = std::vector<std::shared_ptr<const SectionTable<V>>>;
+
+    private:
+
+        Tables_t _tabs;
+
+        // the cascade in the state of the stream
+        RuntimeSeries<V> _S;
+
+        // the warm-up length and the length of a chunk, a multiple of M*M
+        size_t _W, _C;
+
+        static Tables_t make_tables(const T* coefs, const int n){
+
+            Tables_t tabs;
+            for (int i=0;i<n;i++)
+                tabs.push_back(make_section_table<V>(coefs + 5*i));
+
+            return tabs;
+        }
+
+        // filter len samples by the cascade S, tiles by option 3, then rows by option 1 and scalars.
+        static inline void _filter(RuntimeSeries<V>& S, const T* in, T* out, const size_t len){
+
+            size_t n = 0;
+
+            for (; n+L <= len; n += L){
+
+                std::array<V,M> v;
+                for (auto m=0; m<M; m++) v[m].load(in + n + m*M);
+
+                v = _permuteV(S.series_option3(_permuteV(v)));
+                for (auto m=0; m<M; m++) v[m].store(out + n + m*M);
+            }
+
+            V v;
+            for (; n+M <= len; n += M) S.series_option1(v.load(in + n)).store(out + n);
+
+            for (; n < len; n++) out[n] = S.series_scalar(in[n]);
+        }
+
+    public:
+
+        /*
+            n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2] with poles inside the unit circle, tol: the error
+            relative to the largest output, chunk: the samples of a chunk, 8 warm-up lengths by default so that the warm-up costs
+            1/8 more work. inits: the initial conditions [xi1 xi2 yi1 yi2] of each section, zero by default.
+         */
+        WarmupFilter(const T* coefs,const int n,const double tol=1e-6,const size_t chunk=0,const T* inits=nullptr): _tabs(make_tables(coefs,n)){
+
+            std::vector<T> zeros(4*n, T(0));
+            _S = RuntimeSeries<V>(_tabs, inits ? inits : zeros.data());
+
+            _W = warmup_length(coefs, n, tol);
+
+            _C = (chunk > 0) ? chunk : std::max<size_t>(8*_W, 64*L);
+            _C = (_C + L - 1)/L*L;
+        }
+
+        template<int K> WarmupFilter(const T (&coefs)[K][5],const double tol=1e-6,const size_t chunk=0): WarmupFilter(&coefs[0][0],K,tol,chunk){}
+
+        template<int K> WarmupFilter(const T (&coefs)[K][5],const T (&inits)[K][4],const double tol=1e-6,const size_t chunk=0)
+        : WarmupFilter(&coefs[0][0],K,tol,chunk,&inits[0][0]){}
+
+    // filter len samples by independent chunks, the state is kept for the next call.
+    inline void operator()(const T* in,T* out,const size_t len){
+
+        const size_t chunks = (len + _C - 1)/_C;
+        if (chunks == 0) return;
+
+        std::vector<T> zeros(4*_tabs.size(), T(0));
+
+        // the cascade of each chunk, the first one continues the stream
+        std::vector<RuntimeSeries<V>> S(chunks);
+
+        tbb::parallel_for(size_t(0), chunks, [&](size_t k){
+
+            size_t first = k*_C, last = std::min(first + _C, len);
+
+            // a chunk close to the start of the call warms up from the state of the stream, which is exact
+            size_t begin = (first > _W) ? first - _W : 0;
+
+            S[k] = (begin == 0) ? _S : RuntimeSeries<V>(_tabs, zeros.data());
+
+            std::vector<T> warm(first - begin);
+            _filter(S[k], in + begin, warm.data(), first - begin);
+            _filter(S[k], in + first, out + first, last - first);
+        });
+
+        _S = S[chunks-1];
+    }
+
+    inline size_t overlap() const { return _W; }
+
+    inline size_t chunk() const { return _C; }
+
+};
+
+#endif // header guard
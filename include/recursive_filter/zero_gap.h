@@ -0,0 +1,177 @@
+#ifndef ZERO_GAP_H
+#define ZERO_GAP_H 1
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include "section_table.h"
+#include "matrix_ops.h"
+
+/*
+    advance the initial conditions [xi1 xi2 yi1 yi2] of n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2] over K
+    samples of zero input, in O((2n)^3 log K) rather than O(nK). Only the first section sees zeros, the rest see the decaying
+    outputs of the sections before, so the sections do not advance alone: after two samples, in which the initial conditions
+    of inputs are shifted out, the state of the cascade is the outputs [y_{-1} y_{-2}] of every section and one sample is a
+    2n by 2n transition matrix, whose K-2 power is computed by repeated squaring.
+ */
+template<typename T> inline void advance_zero(const T* coefs, const int n, T* inits, size_t K) {
+
+    // the first two samples by the recursive equations, the input of each section is the output of the one before
+    for (int k=0; k<2 && K > 0; k++, K--){
+
+        T x = 0;
+
+        for (int i=0; i<n; i++){
+
+            const T* c = coefs + 5*i;
+            T* s = inits + 4*i;
+
+            T y = x + c[1]*s[0] + c[2]*s[1] + c[3]*s[2] + c[4]*s[3];
+
+            s[1] = s[0]; s[0] = x;
+            s[3] = s[2]; s[2] = y;
+
+            x = y;
+        }
+    }
+
+    if (K == 0) return;
+
+    // one sample of the cascade: s = [y_{-1} y_{-2}] of every section, row 2i is the new output of section i
+    const int S = 2*n;
+    std::vector<double> A(S*S, 0.0);
+
+    for (int i=0; i<n; i++){
+
+        const T* c = coefs + 5*i;
+        double* r = &A[2*i*S];
+
+        // the new output of the section before is its input x_n
+        if (i > 0) for (int q=0; q<S; q++) r[q] = A[2*(i-1)*S + q];
+
+        if (i > 0){
+            r[2*(i-1)] += c[1];
+            r[2*(i-1)+1] += c[2];
+        }
+
+        r[2*i] += c[3];
+        r[2*i+1] += c[4];
+
+        // y_{-2} takes y_{-1}
+        A[(2*i+1)*S + 2*i] = 1;
+    }
+
+    const std::vector<double> P = _mat_power(A, K, S);
+
+    std::vector<double> s(S);
+    for (int i=0; i<n; i++){
+
+        s[2*i] = inits[4*i+2];
+        s[2*i+1] = inits[4*i+3];
+    }
+
+    for (int i=0; i<n; i++){
+
+        double y1 = 0, y2 = 0;
+        for (int q=0; q<S; q++){
+
+            y1 += P[2*i*S + q]*s[q];
+            y2 += P[(2*i+1)*S + q]*s[q];
+        }
+
+        inits[4*i+2] = y1;
+        inits[4*i+3] = y2;
+    }
+
+    // the inputs of a section are the outputs of the one before, and zeros for the first one
+    for (int i=0; i<n; i++){
+
+        inits[4*i] = (i > 0) ? inits[4*(i-1)+2] : T(0);
+        inits[4*i+1] = (i > 0) ? inits[4*(i-1)+3] : T(0);
+    }
+};
+
+template<typename T, int N> inline void advance_zero(const T (&coefs)[N][5], T (&inits)[N][4], const size_t K) {
+    advance_zero(&coefs[0][0], N, &inits[0][0], K);
+};
+
+// advance the initial conditions of cascaded sections given by their pre-computed tables.
+template<typename V, typename T> inline void advance_zero(const std::vector<std::shared_ptr<const SectionTable<V>>>& tabs, T* inits, const size_t K) {
+
+    std::vector<T> coefs;
+    for (auto& t: tabs) coefs.insert(coefs.end(), {T(1), t->b1, t->b2, t->a1, t->a2});
+
+    advance_zero(coefs.data(), int(tabs.size()), inits, K);
+};
+
+// the largest radius of the poles of n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2], i.e., of z^2 - a1 z - a2.
+template<typename T> inline double pole_radius(const T* coefs, const int n) {
+
+    double r = 0;
+
+    for (int i=0; i<n; i++){
+
+        double a1 = coefs[5*i+3], a2 = coefs[5*i+4];
+        double d = a1*a1 + 4*a2;
+
+        r = std::max(r, (d < 0) ? std::sqrt(-a2) : (std::abs(a1) + std::sqrt(d))/2);
+    }
+
+    return r;
+};
+
+/*
+    a bound of the zero-input response of n cascaded sections from their initial conditions s [xi1 xi2 yi1 yi2], i.e., every
+    output is at most G max|s|, where G is the sum of the peaks of the responses from each unit initial condition. The poles
+    must be inside the unit circle. Each response is followed until its state is below rel times its peak, and at most over
+    the horizon where the largest pole radius has decayed by rel, as in warmup_length.
+ */
+template<typename T> inline double state_gain(const T* coefs, const int n, const double rel=1e-9) {
+
+    const double radius = pole_radius(coefs, n);
+    assert(radius < 1 && rel > 0);
+
+    // without poles the state is shifted out after two samples of every section
+    const size_t H = ((radius > 0) ? 4*size_t(std::ceil(std::log(rel)/std::log(radius))) : 0) + 8*n + 64;
+
+    double G = 0;
+    std::vector<double> s(4*n);
+
+    for (int j=0; j<4*n; j++){
+
+        std::fill(s.begin(), s.end(), 0.0);
+        s[j] = 1;
+
+        double peak = 0, m = 1;
+
+        for (size_t k=0; k<H && (k < 2 || m > rel*peak); k++){
+
+            double x = 0;
+            m = 0;
+
+            for (int i=0; i<n; i++){
+
+                const T* c = coefs + 5*i;
+                double* r = s.data() + 4*i;
+
+                double y = x + c[1]*r[0] + c[2]*r[1] + c[3]*r[2] + c[4]*r[3];
+
+                r[1] = r[0]; r[0] = x;
+                r[3] = r[2]; r[2] = y;
+
+                x = y;
+                m = std::max({m, std::abs(r[0]), std::abs(r[1]), std::abs(r[2]), std::abs(r[3])});
+            }
+
+            peak = std::max(peak, std::abs(x));
+        }
+
+        G += peak;
+    }
+
+    return G;
+};
+
+#endif // header guard
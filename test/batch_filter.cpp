@@ -0,0 +1,71 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("ragged batch:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int N = 2;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2}; 
+
+TEST_CASE("records of different lengths and states:"){
+
+    constexpr size_t R = 53;
+
+    std::vector<std::vector<T>> data(R), result(R), inits(R);
+    std::vector<std::vector<double>> ex_result(R), ex_inits(R);
+    std::vector<Record<T>> records;
+
+    for (size_t r = 0; r < R; r++){
+
+        size_t len = (r*37) % 301;
+        data[r] = test_signal<T>(len, 0.05, r);
+        result[r].resize(len);
+
+        inits[r] = {T(0.1*r),T(1),T(-0.2),T(0.01*r), T(4),T(-0.5),T(2.5),T(-0.02*r)};
+
+        // reference: each record on its own section by section, the state after the record is its last two inputs and outputs
+        std::vector<double> x(data[r].begin(), data[r].end());
+        for (int i = 0; i < N; i++){
+
+            auto y = reference(x, coefs[i], 1, &inits[r][4*i]);
+
+            // the samples before the record are the initial conditions
+            x.insert(x.begin(), {inits[r][4*i+1], inits[r][4*i]});
+            y.insert(y.begin(), {inits[r][4*i+3], inits[r][4*i+2]});
+            ex_inits[r].insert(ex_inits[r].end(), {x[len+1], x[len], y[len+1], y[len]});
+
+            x.assign(y.begin()+2, y.end());
+        }
+        ex_result[r] = x;
+
+        records.push_back({data[r].data(), result[r].data(), len, inits[r].data()});
+    }
+
+    BatchFilter<T> filter(coefs, 2);
+    filter(records);
+
+    for (size_t r = 0; r < R; r++){
+        for (size_t n = 0; n < data[r].size(); n++) 
+            CHECK(result[r][n] == doctest::Approx(ex_result[r][n]).epsilon(1e-4));
+        for (size_t q = 0; q < 8; q++) 
+            CHECK(inits[r][q] == doctest::Approx(ex_inits[r][q]).epsilon(1e-4));
+    }
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,79 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <memory>
+#include <iterator>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("coefficient hot-swap:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+const T xi1 = 1, xi2 = 4, yi1 = -0.2, yi2 = 2.5;
+
+TEST_CASE("swap at sample boundaries across calls:"){
+
+    constexpr int N = 2;
+    constexpr size_t len = 40*L+5;
+
+    T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2}; 
+    T coefs2[N][5] = {1,0.1,-0.5,0.5,0.3,1,-0.3,0.2,0.6,-0.3}; 
+    T coefs3[N][5] = {1,0.4,0.1,0.1,0.2,1,-0.3,0.2,0.6,-0.3}; 
+    T inits[N][4] = {xi1,xi2,yi1,yi2,xi2,xi1,yi2,yi1};
+
+    auto data = test_signal<T>(len);
+
+    // swaps in the middle of a block and of a call
+    const size_t at2 = 7*L+13, at3 = 25*L+3;
+
+    IirCoreOrderTwo<V> IIR1(coefs[0], inits[0]), IIR2(coefs[1], inits[1]);
+    std::vector<T> ex_result(len), result(len);
+
+    for (size_t n = 0; n < len; n++){
+        if (n == at2){
+            IIR1.table_refresh(make_section_table<V>(coefs2[0]));
+            IIR2.table_refresh(make_section_table<V>(coefs2[1]));
+        }
+        if (n == at3){
+            IIR1.table_refresh(make_section_table<V>(coefs3[0]));
+            IIR2.table_refresh(make_section_table<V>(coefs3[1]));
+        }
+        ex_result[n] = IIR2.benchmark(IIR1.benchmark(data[n]));
+    }
+
+    auto multi_core_filter = makeMultiCoreFilter(coefs,inits);
+    multi_core_filter.swap_coefs(coefs3, at3);
+    multi_core_filter.swap_coefs(coefs2, at2);
+
+    // the stream arrives in chunks of different lengths
+    auto first = data.begin();
+    auto d_first = result.begin();
+    for (size_t chunk: std::vector<size_t>{3*L+1, 10*L+7, M-1, 20*L, len}){
+        auto last = first + std::min<size_t>(chunk, std::distance(first, data.end()));
+        d_first = multi_core_filter(first, last, d_first);
+        first = last;
+    }
+
+    CHECK(multi_core_filter.position() == len);
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));    
+
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,82 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("fused decimation:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3, 1,2,1,-0.6,-0.2, 1,-0.3,0,0.7,0};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0,2,0};
+
+TEST_CASE("decimation in the multi-core graph:"){
+
+    constexpr size_t len = 13*L;
+
+    auto data = test_signal<T>(len);
+
+    for (size_t D: {1, 2, 3, 7, 8, 100}){
+        for (size_t offset = 0; offset < std::min<size_t>(D, 3); offset++){
+
+            TBBIIRMultiCore<V> full(coefs, inits), dec(coefs, inits);
+
+            auto y = full(data);
+            auto z = dec.decimate(data, D, offset);
+
+            REQUIRE(z.first.size() == (len - offset + D - 1)/D);
+            for (size_t m = 0; m < z.first.size(); m++)
+                CHECK(z.first[m] == y.first[offset + m*D]);
+
+            CHECK(z.second == y.second);
+        }
+    }
+};
+
+TEST_CASE("decimation of a stream over calls of any length:"){
+
+    constexpr size_t len = 23*L+13;
+    const size_t splits[] = {0, 5, 2*L+3, 2*L+10, 11*L+1, 12*L, len};
+
+    auto data = test_signal<T>(len);
+
+    for (size_t D: {1, 3, 5, 16}){
+
+        MultiCoreFilter<T> full(coefs, inits), dec(coefs, inits);
+
+        // the full filter goes over the same calls, so both take the same blocks
+        std::vector<T> y(len);
+        for (size_t k = 0; k + 1 < std::size(splits); k++)
+            full(data.begin() + splits[k], data.begin() + splits[k+1], y.begin() + splits[k]);
+
+        std::vector<T> z((len + D - 1)/D);
+        auto out = z.begin();
+        for (size_t k = 0; k + 1 < std::size(splits); k++)
+            out = dec.decimate(data.begin() + splits[k], data.begin() + splits[k+1], out, D);
+
+        CHECK(out == z.end());
+        CHECK(dec.position() == len);
+
+        for (size_t m = 0; m < z.size(); m++)
+            CHECK(z[m] == y[m*D]);
+    }
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
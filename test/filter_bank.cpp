@@ -0,0 +1,64 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("filter bank:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+TEST_CASE("cascades of different lengths over one input:"){
+
+    std::vector<std::vector<T>> coefs = {
+        {1,0.1,-0.5,0.5,0.3},
+        {1,0.2,0.1,-0.4,0.2, 1,0.4,0.1,-0.6,0.2, 1,-0.3,0.2,0.6,-0.3},
+        {1,0.1,-0.5,0.5,0.3, 1,0.2,0.1,-0.4,0.2}};
+    std::vector<std::vector<T>> inits = {
+        {1,4,-0.2,2.5},
+        {0,0,0,0, 1,4,-0.2,2.5, 4,1,2.5,-0.2},
+        {4,1,2.5,-0.2, 1,4,-0.2,2.5}};
+
+    constexpr size_t len = 30*L+13, split = 11*L+5;
+    const size_t K = coefs.size();
+
+    auto data = test_signal<T>(len);
+
+    std::vector<std::vector<double>> ex_result;
+    std::vector<std::vector<T>> result(K, std::vector<T>(len));
+
+    for (size_t k = 0; k < K; k++)
+        ex_result.push_back(reference(data, coefs[k].data(), coefs[k].size()/5, inits[k].data()));
+
+    FilterBank<T> bank(coefs, inits);
+    CHECK(bank.size() == K);
+
+    std::vector<T*> out, out2;
+    for (auto& r: result){
+        out.push_back(r.data());
+        out2.push_back(r.data() + split);
+    }
+
+    bank(data.data(), split, out);
+    bank(data.data() + split, len - split, out2);
+
+    for (size_t k = 0; k < K; k++)
+        for (size_t n = 0; n < len; n++) 
+            CHECK(result[k][n] == doctest::Approx(ex_result[k][n]).epsilon(1e-3));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
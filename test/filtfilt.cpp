@@ -0,0 +1,98 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("zero-phase filtering:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 2;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2}; 
+T inits[N][4] = {1,4,-0.2,2.5,4,1,2.5,-0.2};
+
+// one pass of the cascade in double that starts in the steady state of its first sample
+std::vector<double> pass(const std::vector<double>& x){
+
+    T zi[N][4];
+    double u = x[0];
+    for (int i=0;i<N;i++){
+        double y = u*(1.0 + coefs[i][1] + coefs[i][2])/(1.0 - coefs[i][3] - coefs[i][4]);
+        zi[i][0] = u; zi[i][1] = u; zi[i][2] = y; zi[i][3] = y;
+        u = y;
+    }
+
+    return reference(x, &coefs[0][0], N, &zi[0][0]);
+}
+
+TEST_CASE("forward and backward with odd extension:"){
+
+    constexpr size_t pad = 3*(2*N+1);
+
+    // a ragged head and many blocks, exact blocks after padding, one block, and less than a block
+    for (size_t len: {size_t(50*L+17), size_t(3*L-2*pad), size_t(L-2*pad), size_t(20)}){
+
+        // an offset that the steady state at the edges has to follow
+        auto data = test_signal<T>(len);
+        for (auto& v: data) v += 2;
+
+        std::vector<T> result(len);
+
+        // reference: pad exactly padlen on each side, filter, reverse, filter, reverse
+        size_t p = std::min<size_t>(pad, len-1);
+        std::vector<double> ext;
+        for (size_t k=0;k<p;k++) ext.push_back(2.0*data[0] - data[p-k]);
+        ext.insert(ext.end(), data.begin(), data.end());
+        for (size_t k=0;k<p;k++) ext.push_back(2.0*data[len-1] - data[len-2-k]);
+
+        ext = pass(ext);
+        std::reverse(ext.begin(), ext.end());
+        ext = pass(ext);
+        std::reverse(ext.begin(), ext.end());
+
+        auto multi_core_filter = makeMultiCoreFilter(coefs,inits);
+        multi_core_filter.filtfilt(data.begin(), data.end(), result.begin());
+
+        CHECK(multi_core_filter.position() == 0);
+
+        for (size_t n = 0; n < len; n++) 
+            CHECK(result[n] == doctest::Approx(ext[p+n]).epsilon(1e-4));
+    }
+
+};
+
+TEST_CASE("the stored initial conditions after filtfilt:"){
+
+    constexpr size_t len = 4*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    // the edge state of filtfilt does not replace the initial conditions of the constructor
+    TBBIIRMultiCore<V> mc(coefs, inits);
+    mc.filtfilt(data);
+
+    auto out = mc(data);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(out.first[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,118 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("first order sections:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+// a second order section, a first order section and a one-pole smoother
+constexpr int N = 3;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3, 1,0.4,0,0.6,0, 1,0,0,0.9,0};
+T inits[N][4] = {1,4,-0.2,2.5, 2,0,-1,0, 0,0,3,0};
+
+TEST_CASE("first order cores:"){
+
+    constexpr size_t len = 6*L;
+
+    auto data = test_signal<T>(len);
+
+    IirCoreOrderTwo<V> ex(coefs[1], inits[1]);
+    IirCoreOrderOne<V> sc(coefs[1], inits[1]), v1(coefs[1], inits[1]), v2(coefs[1], inits[1]), v3(coefs[1], inits[1]);
+
+    std::vector<T> ex_result(len), r_sc(len), r_v1(len), r_v2(len), r_v3(len);
+
+    for (size_t n = 0; n < len; n++){
+        ex_result[n] = ex.benchmark(data[n]);
+        r_sc[n] = sc.benchmark(data[n]);
+    }
+
+    for (size_t n = 0; n < len; n += M){
+        V x;
+        x.load(&data[n]);
+        v1.option1(x).store(&r_v1[n]);
+    }
+
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y2 = v2.option2(x), y3 = v3.option3(x);
+        for (auto j = 0; j < M; j++){
+            y2[j].store(&r_v2[n + j*M]);
+            y3[j].store(&r_v3[n + j*M]);
+        }
+    }
+
+    for (size_t n = 0; n < len; n++){
+        CHECK(r_sc[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v1[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v2[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v3[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+    }
+
+    T post[4];
+    v3.get_inits(post);
+    CHECK(post[0] == data[len-1]);
+    CHECK(post[2] == doctest::Approx(ex_result[len-1]).epsilon(1e-4));
+};
+
+TEST_CASE("first order cores in series:"){
+
+    constexpr size_t len = 4*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    auto S = make_series(IirCoreOrderTwo<V>(coefs[0], inits[0]), IirCoreOrderOne<V>(coefs[1], inits[1]), IirCoreOrderOne<V>(coefs[2], inits[2]));
+
+    std::vector<T> result(len);
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y = _permuteV(S.series_option3(_permuteV(x)));
+        for (auto j = 0; j < M; j++) y[j].store(&result[n + j*M]);
+    }
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+};
+
+TEST_CASE("first order sections in the multi-core graph:"){
+
+    constexpr size_t len = 21*L+5, split = 9*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    std::vector<T> result(len);
+
+    MultiCoreFilter<T> filter(coefs, inits);
+    filter(data.begin(), data.begin() + split, result.begin());
+    filter(data.begin() + split, data.end(), result.begin() + split);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,44 @@
+#ifndef TEST_FIXTURES_H
+#define TEST_FIXTURES_H 1
+
+#include <vector>
+#include <cmath>
+#include <type_traits>
+
+// the test signal of len samples from sample from on, a sinusoid of frequency w with a ramp of period 7 on top.
+template<typename T> std::vector<T> test_signal(const size_t len, const double w = 0.05, const size_t from = 0){
+
+    std::vector<T> data(len);
+    for (size_t n = 0; n < len; n++) data[n] = std::sin(w*(n+from)) + 0.1*((n+from)%7);
+
+    return data;
+}
+
+/*
+    n cascaded sections of contiguous coefficients [b0 b1 b2 a1 a2] by their recursive equations in double precision, from the
+    initial conditions [xi1 xi2 yi1 yi2] of each section or from rest. b0 is ignored as in the sections unless with_b0.
+ */
+template<typename U, typename T> std::vector<double> reference(const std::vector<U>& data, const T* coefs, const int n,
+                                                              const std::type_identity_t<T>* inits = nullptr, const bool with_b0 = false){
+
+    std::vector<double> y(data.begin(), data.end());
+
+    for (int i = 0; i < n; i++){
+
+        const T* c = coefs + 5*i;
+        const double b0 = with_b0 ? c[0] : 1;
+
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        if (inits){ x1 = inits[4*i]; x2 = inits[4*i+1]; y1 = inits[4*i+2]; y2 = inits[4*i+3]; }
+
+        for (auto& v: y){
+            double r = b0*v + c[1]*x1 + c[2]*x2 + c[3]*y1 + c[4]*y2;
+            x2 = x1; x1 = v; y2 = y1; y1 = r;
+            v = r;
+        }
+    }
+
+    return y;
+}
+
+#endif // header guard
@@ -0,0 +1,195 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("allpass sections and half-band resampling:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+// the coefficients of the two phases of a half-band lowpass filter
+const std::vector<T> c0 = {0.0798, 0.5453, 0.8769};
+const std::vector<T> c1 = {0.2838, 0.7417};
+
+// the allpass section 1 - a1 z^{-1} - a2 z^{-2} by its recursive equation in double precision
+std::vector<double> allpass(const std::vector<T>& x, const T a1, const T a2, const T inits[4]){
+
+    const T c[5] = {(a2 == 0) ? -a1 : -a2, (a2 == 0) ? T(1) : -a1, (a2 == 0) ? T(0) : T(1), a1, a2};
+
+    return reference(x, c, 1, inits, true);
+}
+
+// a phase at the high rate, the cascade of (c + z^{-2})/(1 + c z^{-2}) from rest
+std::vector<double> phase(std::vector<double> x, const std::vector<T>& c){
+
+    for (auto ck: c){
+
+        std::vector<double> y(x.size());
+        for (size_t n = 0; n < x.size(); n++)
+            y[n] = ck*x[n] + ((n >= 2) ? x[n-2] - ck*y[n-2] : 0.0);
+
+        x = y;
+    }
+
+    return x;
+}
+
+// H(z) = A0(z^2) + z^{-1} A1(z^2) at the high rate, without the factor 1/2
+std::vector<double> halfband(const std::vector<double>& x){
+
+    std::vector<double> d(x.size(), 0.0);
+    for (size_t n = 1; n < x.size(); n++) d[n] = x[n-1];
+
+    auto y0 = phase(x, c0), y1 = phase(d, c1);
+    for (size_t n = 0; n < x.size(); n++) y0[n] += y1[n];
+
+    return y0;
+}
+
+void check_core(const T a1, const T a2){
+
+    constexpr size_t len = 5*L;
+    const T inits[4] = {0.3, -0.2, 0.5, 0.1};
+
+    auto data = test_signal<T>(len);
+    auto ex_result = allpass(data, a1, a2, inits);
+
+    IirCoreAllpass<V> sc(a1, a2, inits[0], inits[1], inits[2], inits[3]), v1(sc), v2(sc), v3(sc);
+
+    std::vector<T> r_sc(len), r_v1(len), r_v2(len), r_v3(len);
+
+    for (size_t n = 0; n < len; n++) r_sc[n] = sc.benchmark(data[n]);
+
+    for (size_t n = 0; n < len; n += M){
+        V x;
+        x.load(&data[n]);
+        v1.option1(x).store(&r_v1[n]);
+    }
+
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y2 = v2.option2(x), y3 = v3.option3(x);
+        for (auto j = 0; j < M; j++){
+            y2[j].store(&r_v2[n + j*M]);
+            y3[j].store(&r_v3[n + j*M]);
+        }
+    }
+
+    for (size_t n = 0; n < len; n++){
+        CHECK(r_sc[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v1[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v2[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v3[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+    }
+
+    T post[4];
+    v3.get_inits(post);
+    CHECK(post[0] == data[len-1]);
+    CHECK(post[1] == data[len-2]);
+    CHECK(post[2] == doctest::Approx(ex_result[len-1]).epsilon(1e-4));
+}
+
+TEST_CASE("allpass cores of first and second order:"){
+
+    check_core(-0.6, 0);
+    check_core(0.45, 0);
+    check_core(-0.5, -0.2);
+    check_core(0.9, -0.5);
+};
+
+TEST_CASE("allpass sections in the multi-core graph:"){
+
+    constexpr size_t len = 9*L;
+
+    // a first order and a second order allpass section
+    const T a[2][2] = {{0.45, 0}, {0.9, -0.5}};
+    const T inits[2][4] = {{0.3, -0.2, 0.5, 0.1}, {-1, 0.4, 0.2, 0.7}};
+
+    auto data = test_signal<T>(len);
+    const T c[2][5] = {{-a[0][0], 1, 0, a[0][0], 0}, {-a[1][1], -a[1][0], 1, a[1][0], a[1][1]}};
+    auto ex_result = reference(data, &c[0][0], 2, &inits[0][0], true);
+
+    std::vector<std::shared_ptr<const AllpassTable<V>>> tabs = {make_allpass_table<V>(a[0][0], a[0][1]), make_allpass_table<V>(a[1][0], a[1][1])};
+    TBBIIRMultiCore<V> mc(tabs, &inits[0][0]);
+
+    auto result = mc(data);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result.first[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+
+    CHECK(result.second[1] == data[len-1]);
+    CHECK(result.second[7] == doctest::Approx(ex_result[len-1]).epsilon(1e-4));
+};
+
+TEST_CASE("half-band decimator over several calls:"){
+
+    constexpr size_t len = 2*(11*L+13), split1 = 2*(3*L+5), split2 = 2*(7*L);
+
+    auto data = test_signal<T>(len);
+    auto ex_result = halfband(std::vector<double>(data.begin(), data.end()));
+
+    HalfbandDecimator<T> dec(c0, c1);
+
+    std::vector<T> result(len/2);
+    dec(data.data(), result.data(), split1);
+    dec(data.data() + split1, result.data() + split1/2, split2 - split1);
+    dec(data.data() + split2, result.data() + split2/2, len - split2);
+
+    for (size_t m = 0; m < len/2; m++)
+        CHECK(result[m] == doctest::Approx(0.5*ex_result[2*m]).epsilon(1e-3));
+};
+
+TEST_CASE("half-band interpolator over several calls:"){
+
+    constexpr size_t len = 9*L+7, split = 4*L+3;
+
+    auto data = test_signal<T>(len);
+
+    std::vector<double> stuffed(2*len, 0.0);
+    for (size_t m = 0; m < len; m++) stuffed[2*m] = data[m];
+    auto ex_result = halfband(stuffed);
+
+    HalfbandInterpolator<T> itp(c0, c1);
+
+    std::vector<T> result(2*len);
+    itp(data.data(), result.data(), split);
+    itp(data.data() + split, result.data() + 2*split, len - split);
+
+    for (size_t n = 0; n < 2*len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_CASE("unit gain at DC and zero gain at Nyquist:"){
+
+    constexpr size_t len = 2*16*L;
+
+    std::vector<T> dc(len, 1), ny(len), r_dc(len/2), r_ny(len/2);
+    for (size_t n = 0; n < len; n++) ny[n] = (n%2) ? -1 : 1;
+
+    HalfbandDecimator<T> d0(c0, c1), d1(c0, c1);
+    d0(dc.data(), r_dc.data(), len);
+    d1(ny.data(), r_ny.data(), len);
+
+    CHECK(r_dc[len/2-1] == doctest::Approx(1).epsilon(1e-4));
+    CHECK(std::abs(r_ny[len/2-1]) < 1e-4);
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,245 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("higher order sections:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+// six second order sections with well separated poles
+constexpr int N = 6;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3, 1,0.4,0.2,-0.6,-0.2, 1,-0.3,0.1,0.9,-0.5,
+                 1,0.2,0.3,-0.1,0.4, 1,0.5,-0.1,0.2,-0.7, 1,-0.2,-0.4,1.2,-0.45};
+
+template<int P> void check_cores(){
+
+    constexpr size_t len = 7*L;
+
+    auto data = test_signal<T>(len);
+
+    // the first P/2 sections merged
+    auto merged = merge_sections<P>(&coefs[0][0], P/2);
+    T inits[2*P];
+    for (auto k = 0; k < 2*P; k++) inits[k] = (k%2 ? -0.3 : 0.5)*(k%P + 1);
+
+    // the direct section by the recursive equation
+    std::vector<T> ex_result(len);
+    {
+        std::vector<double> x(inits, inits + P), y(inits + P, inits + 2*P);
+        for (size_t n = 0; n < len; n++){
+            double r = data[n];
+            for (auto k = 0; k < P; k++) r += merged[1+k]*x[k] + merged[1+P+k]*y[k];
+            x.insert(x.begin(), data[n]); x.pop_back();
+            y.insert(y.begin(), r); y.pop_back();
+            ex_result[n] = r;
+        }
+    }
+
+    IirCoreOrderP<V,P> sc(merged.data(), inits), v1(merged.data(), inits), v2(merged.data(), inits), v3(merged.data(), inits);
+
+    std::vector<T> r_sc(len), r_v1(len), r_v2(len), r_v3(len);
+
+    for (size_t n = 0; n < len; n++) r_sc[n] = sc.benchmark(data[n]);
+
+    for (size_t n = 0; n < len; n += M){
+        V x;
+        x.load(&data[n]);
+        v1.option1(x).store(&r_v1[n]);
+    }
+
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y2 = v2.option2(x), y3 = v3.option3(x);
+        for (auto j = 0; j < M; j++){
+            y2[j].store(&r_v2[n + j*M]);
+            y3[j].store(&r_v3[n + j*M]);
+        }
+    }
+
+    for (size_t n = 0; n < len; n++){
+        CHECK(r_sc[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+        CHECK(r_v1[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+        CHECK(r_v2[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+        CHECK(r_v3[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+    }
+
+    T post[2*P];
+    v3.get_inits(post);
+    for (auto k = 0; k < P; k++){
+        CHECK(post[k] == data[len-1-k]);
+        CHECK(post[P+k] == doctest::Approx(ex_result[len-1-k]).epsilon(1e-3));
+    }
+}
+
+TEST_CASE("fourth order cores:"){ check_cores<4>(); };
+
+TEST_CASE("sixth order cores:"){ check_cores<6>(); };
+
+TEST_CASE("merged sections keep the transfer function:"){
+
+    constexpr size_t len = 10*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N);
+
+    auto m4 = merge_sections<4>(&coefs[0][0], N);
+    auto m6 = merge_sections<6>(&coefs[0][0], N);
+    const T zeros[12] = {0};
+
+    // the same cascade by 6 second order, 3 fourth order and 2 sixth order sections
+    const T sos_inits[4] = {0};
+    auto S2 = make_series(IirCoreOrderTwo<V>(coefs[0], sos_inits), IirCoreOrderTwo<V>(coefs[1], sos_inits), IirCoreOrderTwo<V>(coefs[2], sos_inits),
+                          IirCoreOrderTwo<V>(coefs[3], sos_inits), IirCoreOrderTwo<V>(coefs[4], sos_inits), IirCoreOrderTwo<V>(coefs[5], sos_inits));
+    auto S4 = make_series(IirCoreOrderFour<V>(&m4[0], zeros), IirCoreOrderFour<V>(&m4[9], zeros), IirCoreOrderFour<V>(&m4[18], zeros));
+    auto S6 = make_series(IirCoreOrderSix<V>(&m6[0], zeros), IirCoreOrderSix<V>(&m6[13], zeros));
+
+    std::vector<T> r2(len), r4(len), r6(len);
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto x_T = _permuteV(x);
+        auto y2 = _permuteV(S2.series_option3(x_T)), y4 = _permuteV(S4.series_option3(x_T)), y6 = _permuteV(S6.series_option3(x_T));
+        for (auto j = 0; j < M; j++){
+            y2[j].store(&r2[n + j*M]);
+            y4[j].store(&r4[n + j*M]);
+            y6[j].store(&r6[n + j*M]);
+        }
+    }
+
+    // the error of each realization relative to the peak of the reference
+    double peak = 0, e2 = 0, e4 = 0, e6 = 0;
+    for (size_t n = 0; n < len; n++){
+        peak = std::max(peak, std::abs(ex_result[n]));
+        e2 = std::max(e2, std::abs(r2[n] - ex_result[n]));
+        e4 = std::max(e4, std::abs(r4[n] - ex_result[n]));
+        e6 = std::max(e6, std::abs(r6[n] - ex_result[n]));
+    }
+
+    MESSAGE("max relative error, sos: " << e2/peak << ", order 4: " << e4/peak << ", order 6: " << e6/peak);
+
+    CHECK(e2/peak < 1e-4);
+    CHECK(e4/peak < 1e-3);
+    CHECK(e6/peak < 1e-3);
+};
+
+TEST_CASE("merged sections are checked against the cascade:"){
+
+    // two sections whose poles are close to each other and to the unit circle, the roots of their product are too sensitive
+    const double r1 = 0.9995, w1 = 0.010, r2 = 0.999, w2 = 0.012;
+    const T close[2][5] = {{1,0,0,T(2*r1*std::cos(w1)),T(-r1*r1)}, {1,0,0,T(2*r2*std::cos(w2)),T(-r2*r2)}};
+
+    // the separated sections, the close pair and one that does not fill a group
+    std::vector<T> all(&coefs[0][0], &coefs[0][0] + 5*N);
+    all.insert(all.end(), &close[0][0], &close[0][0] + 10);
+    all.insert(all.end(), coefs[3], coefs[3] + 5);
+
+    std::vector<T> rest;
+    auto m4 = merge_sections<4>(all.data(), N+3, &rest);
+
+    CHECK(m4 == merge_sections<4>(&coefs[0][0], N));
+    CHECK(rest == std::vector<T>(all.begin() + 5*N, all.end()));
+};
+
+TEST_CASE("merged sections on the multi-core graph:"){
+
+    constexpr int P = 4;
+    constexpr size_t len = 13*L;
+
+    auto data = test_signal<T>(len);
+    auto merged = merge_sections<P>(&coefs[0][0], N);
+
+    std::vector<T> inits(2*P*N/2);
+    for (size_t k = 0; k < inits.size(); k++) inits[k] = (k%2 ? -0.2 : 0.3)*(k%P + 1);
+
+    std::vector<std::shared_ptr<const HigherOrderStages<V>>> stages;
+    for (auto i = 0; i < N/2; i++)
+        stages.push_back(make_higher_order_stages<V,P>(make_higher_order_table<V,P>(&merged[i*(1+2*P)])));
+
+    TBBIIRMultiCore<V> mc(stages, {}, inits.data());
+    IirCoreOrderFour<V> S4[3] = {{&merged[0], &inits[0]}, {&merged[9], &inits[8]}, {&merged[18], &inits[16]}};
+
+    // 13 blocks in a full buffer of M blocks and the last ones, over two calls that hand over the state
+    std::vector<T> first(data.begin(), data.begin() + 5*L), second(data.begin() + 5*L, data.end());
+    auto y1 = mc(first);
+    auto y2 = mc(second);
+
+    std::vector<T> out(y1.first);
+    out.insert(out.end(), y2.first.begin(), y2.first.end());
+
+    std::vector<T> ex_result(len);
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y = _permuteV(S4[2].option3_middle(S4[1].option3_middle(S4[0].option3_middle(_permuteV(x)))));
+        for (auto j = 0; j < M; j++) y[j].store(&ex_result[n + j*M]);
+    }
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(out[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+
+    T post[3*2*P];
+    for (auto i = 0; i < 3; i++) S4[i].get_inits(post + 2*P*i);
+    REQUIRE(y2.second.size() == 3*2*P);
+    for (auto k = 0; k < 3*2*P; k++)
+        CHECK(y2.second[k] == doctest::Approx(post[k]).epsilon(1e-3));
+};
+
+TEST_CASE("multi-core filter of merged sections:"){
+
+    constexpr size_t len = 17*L + 45;
+
+    // 7 sections, three pairs are merged and the last one stays second order
+    std::vector<T> all(&coefs[0][0], &coefs[0][0] + 5*N);
+    all.insert(all.end(), coefs[1], coefs[1] + 5);
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, all.data(), N+1);
+
+    auto filter = makeMergedFilter<4>(all.data(), N+1);
+
+    // calls of whole blocks and of samples on the single core in between
+    std::vector<T> out(len);
+    const size_t cuts[] = {0, 3*L + 5, 3*L + 21, 12*L + 2, len};
+    for (auto c = 0; c < 4; c++)
+        filter(data.begin() + cuts[c], data.begin() + cuts[c+1], out.begin() + cuts[c]);
+
+    double peak = 0, err = 0;
+    for (size_t n = 0; n < len; n++){
+        peak = std::max(peak, std::abs(ex_result[n]));
+        err = std::max(err, std::abs(out[n] - ex_result[n]));
+    }
+
+    CHECK(err/peak < 1e-3);
+
+    // the state of the first merged section holds the last inputs
+    T state[3*8 + 4];
+    filter.get_inits(state);
+    for (auto k = 0; k < 4; k++)
+        CHECK(state[k] == data[len-1-k]);
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
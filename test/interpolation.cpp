@@ -0,0 +1,104 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("zero-stuffing-aware interpolation:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+// the first section with a general numerator, with a lowpass, all-pole, highpass and bandpass numerator
+T coefs[5][N][5] = {{1,0.1,-0.5,0.5,-0.3, 1,2,1,-0.6,-0.2, 1,-0.3,0,0.7,0},
+                    {1,2,1,0.9,-0.5, 1,0.1,-0.5,0.5,-0.3, 1,0,0,0.2,-0.1},
+                    {1,0,0,0.5,-0.3, 1,2,1,-0.6,-0.2, 1,-0.3,0.4,0.1,0.2},
+                    {1,-2,1,0.4,-0.6, 1,0.1,-0.5,0.5,-0.3, 1,2,1,-0.6,-0.2},
+                    {1,0,-1,-0.3,-0.5, 1,-2,1,0.4,-0.6, 1,0,0,0.2,-0.1}};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0,2,0};
+
+std::vector<T> stuff(const std::vector<T>& x, const size_t U){
+
+    std::vector<T> s(x.size()*U, T(0));
+    for (size_t m = 0; m < x.size(); m++) s[m*U] = x[m];
+
+    return s;
+}
+
+TEST_CASE("the multi-core graph gives the output of the stuffed signal:"){
+
+    constexpr size_t len = 3*L;
+
+    // the signal starts at zero, and with an offset at a non-zero first sample
+    auto data = test_signal<T>(len, 0.3), offset = data;
+    for (auto& v: offset) v += T(0.7);
+
+    for (auto x: {&data, &offset}){
+        for (int c = 0; c < 5; c++){
+            for (size_t U: {1, 2, 3, 4, 5, 8}){
+
+                TBBIIRMultiCore<V> full(coefs[c], inits), itp(coefs[c], inits);
+
+                auto y = full(stuff(*x, U));
+                auto z = itp.interpolate(*x, U);
+
+                REQUIRE(z.first.size() == len*U);
+
+                // the products with zeros are skipped, the rest is computed in the same order
+                for (size_t n = 0; n < len*U; n++)
+                    CHECK(z.first[n] == y.first[n]);
+
+                CHECK(z.second == y.second);
+            }
+        }
+    }
+};
+
+TEST_CASE("interpolation of a stream with a swap of coefficients:"){
+
+    constexpr size_t len = 9*L+5;
+    const size_t splits[] = {0, 3, L+1, 5*L, len};
+
+    auto data = test_signal<T>(len, 0.3);
+
+    for (size_t U: {2, 3, 4}){
+
+        // the swap falls within the zeros of a sample
+        const size_t at = 11*L+1;
+
+        MultiCoreFilter<T> full(coefs[0], inits), itp(coefs[0], inits);
+        full.swap_coefs(coefs[1], at);
+        itp.swap_coefs(coefs[1], at);
+
+        auto stuffed = stuff(data, U);
+        std::vector<T> y(len*U), z(len*U);
+        full(stuffed.begin(), stuffed.end(), y.begin());
+
+        auto out = z.begin();
+        for (size_t k = 0; k + 1 < std::size(splits); k++)
+            out = itp.interpolate(data.begin() + splits[k], data.begin() + splits[k+1], out, U);
+
+        CHECK(out == z.end());
+        CHECK(itp.position() == len*U);
+
+        for (size_t n = 0; n < len*U; n++)
+            CHECK(z[n] == doctest::Approx(y[n]).epsilon(1e-4));
+    }
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,80 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("linear recurrence scan:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+TEST_CASE("first order with coefficients per sample:"){
+
+    constexpr size_t len = 300*L+13;
+
+    auto x = test_signal<T>(len);
+
+    std::vector<T> a(len), ex_result(len), result(len);
+    for (size_t n = 0; n < len; n++) a[n] = 0.9 + 0.09*std::sin(0.01*n);
+
+    T y = 2.5;
+    for (size_t n = 0; n < len; n++){
+        y = a[n]*y + x[n];
+        ex_result[n] = y;
+    }
+
+    T last = LinearScan<V>::scan(a.data(), x.data(), result.data(), len, T(2.5), 16);
+
+    CHECK(last == doctest::Approx(ex_result[len-1]).epsilon(1e-3));
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+
+    // in place
+    linear_scan(a.data(), x.data(), x.data(), len, T(2.5));
+    for (size_t n = 0; n < len; n++) 
+        CHECK(x[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_CASE("second order with coefficients per sample:"){
+
+    constexpr size_t len = 300*L+37;
+
+    auto x = test_signal<T>(len);
+
+    std::vector<T> a1(len), a2(len), ex_result(len), result(len);
+    for (size_t n = 0; n < len; n++){
+        a1[n] = 0.6 + 0.3*std::sin(0.002*n);
+        a2[n] = -0.5 - 0.1*std::cos(0.003*n);
+    }
+
+    T y1 = -0.2, y2 = 1.5;
+    for (size_t n = 0; n < len; n++){
+        T y = a1[n]*y1 + a2[n]*y2 + x[n];
+        y2 = y1;
+        y1 = y;
+        ex_result[n] = y;
+    }
+
+    auto last = LinearScan<V>::scan(a1.data(), a2.data(), x.data(), result.data(), len, T(-0.2), T(1.5), 16);
+
+    CHECK(last[0] == doctest::Approx(ex_result[len-1]).epsilon(1e-3));
+    CHECK(last[1] == doctest::Approx(ex_result[len-2]).epsilon(1e-3));
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
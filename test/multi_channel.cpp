@@ -0,0 +1,59 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("multichannel filtering:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+
+constexpr int N = 2;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2}; 
+T inits[N][4] = {1,4,-0.2,2.5,4,1,2.5,-0.2};
+
+TEST_CASE("channels in lanes across calls:"){
+
+    // channels that do not fill the last group, calls that are not a multiple of M
+    constexpr int channels = 2*M+3;
+    constexpr size_t len = 20*M+5, split = 7*M+3;
+
+    // each channel starts at another sample of the test signal
+    std::vector<T> data, result(channels*len);
+    std::vector<double> ex_result;
+    for (int c = 0; c < channels; c++){
+        auto x = test_signal<T>(len, 0.05, c);
+        auto y = reference(x, &coefs[0][0], N, &inits[0][0]);
+        data.insert(data.end(), x.begin(), x.end());
+        ex_result.insert(ex_result.end(), y.begin(), y.end());
+    }
+
+    MultiChannelFilter<T> filter(coefs, inits, channels);
+    filter(data.data(), result.data(), split, len);
+    filter(data.data() + split, result.data() + split, len - split, len);
+
+    for (size_t n = 0; n < channels*len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+
+    // the state of one channel
+    T post[N][4];
+    filter.get_inits(channels-1, &post[0][0]);
+    CHECK(post[1][2] == doctest::Approx(ex_result[channels*len-1]));
+    CHECK(post[1][3] == doctest::Approx(ex_result[channels*len-2]));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
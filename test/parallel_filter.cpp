@@ -0,0 +1,111 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("parallel form:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+TEST_CASE("complex and real poles:"){
+
+    // complex poles, two real poles, and one real pole with a zero
+    T coefs[3][5] = {1,0.1,-0.5,0.5,-0.3, 1,0.2,0.1,-0.1,0.2, 1,-0.4,0,0.6,0};
+
+    constexpr size_t len = 20*L+13, split = 7*L+5;
+
+    auto data = test_signal<T>(len);
+    std::vector<T> result(len);
+
+    auto ex_result = reference(data, &coefs[0][0], 3);
+
+    ParallelFilter<T> filter(coefs);
+    CHECK(filter.size() == 3);
+    CHECK(filter.form().fir.size() == 1);
+
+    filter(data.data(), result.data(), split);
+    filter(data.data() + split, result.data() + split, 3);
+    filter(data.data() + split + 3, result.data() + split + 3, len - split - 3);
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-5));
+
+    // the branches are summed in the same order whatever order they finish in
+    std::vector<T> r1(len), r2(len);
+    ParallelFilter<T> first(coefs), second(coefs);
+    first(data.data(), r1.data(), len);
+    second(data.data(), r2.data(), len);
+
+    CHECK(r1 == r2);
+};
+
+TEST_CASE("sections without poles:"){
+
+    T coefs[2][5] = {1,0.3,0.2,0,0, 1,0.2,0.1,0.4,-0.2};
+
+    constexpr size_t len = 3*L+5;
+
+    auto data = test_signal<T>(len, 0.1);
+    std::vector<T> result(len);
+
+    auto ex_result = reference(data, &coefs[0][0], 2);
+
+    ParallelFilter<T> filter(coefs);
+    CHECK(filter.size() == 1);
+    CHECK(filter.form().fir.size() == 3);
+
+    filter(data.data(), result.data(), L+2);
+    filter(data.data() + L+2, result.data() + L+2, len - L-2);
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-5));
+};
+
+TEST_CASE("initial conditions of the cascade:"){
+
+    // poles only, a zero section in front (the direct term reads x_{-1}, x_{-2}), and two of them (it reads older inputs too)
+    T c1[2][5] = {1,0.1,-0.5,0.5,-0.3, 1,0.2,0.1,-0.1,0.2};
+    T i1[2][4] = {0.5,-0.2,1.5,0.7, -0.4,0.3,2,-1};
+    T c2[2][5] = {1,0.3,0.2,0,0, 1,0.2,0.1,0.4,-0.2};
+    T i2[2][4] = {0.5,-0.2,0.1,0.3, 0.8,0.2,1.2,-0.6};
+    T c3[3][5] = {1,0.3,0.2,0,0, 1,-0.5,0.4,0,0, 1,0.2,0.1,0.4,-0.2};
+    T i3[3][4] = {0.5,-0.2,0.1,0.3, -0.7,0.9,0.4,-0.5, 0.8,0.2,1.2,-0.6};
+
+    constexpr size_t len = 4*L+9;
+
+    auto data = test_signal<T>(len, 0.1);
+
+    auto check = [&](const auto& coefs, const auto& inits){
+
+        auto ex_result = reference(data, &coefs[0][0], std::size(coefs), &inits[0][0]);
+
+        std::vector<T> result(len);
+        ParallelFilter<T> filter(coefs, inits);
+        filter(data.data(), result.data(), 5);
+        filter(data.data() + 5, result.data() + 5, len - 5);
+
+        for (size_t n = 0; n < len; n++)
+            CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-5));
+    };
+
+    check(c1, i1);
+    check(c2, i2);
+    check(c3, i3);
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,80 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <memory>
+#include <iterator>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("runtime number of cascaded sos:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+const T b1 = 0.1, b2 = -0.5, a1 = 0.5, a2 = 0.3, xi1 = 1, xi2 = 4, yi1 = -0.2, yi2 = 2.5;
+
+TEST_CASE("filter design loaded at runtime:"){
+
+    // more sections than the largest fused kernel, so that both the chunks and the dispatch table are used.
+    const int N = 11;
+    constexpr size_t len = 20*L+2*M+3;
+
+    auto data = test_signal<T>(len, 0.01);
+
+    // contiguous sos and initial conditions, as loaded from a configuration file
+    std::vector<T> coefs, inits;
+    for (int i = 0; i < N; i++){
+        T s = 1 - 0.05*i;
+        coefs.insert(coefs.end(), {1, b1*s, b2*s, a1*s, a2*s});
+        inits.insert(inits.end(), {xi1, xi2, yi1, yi2});
+    }
+
+    auto ex_result = reference(data, coefs.data(), N, inits.data());
+    std::vector<T> result(len);
+
+    auto multi_core_filter = makeMultiCoreFilter(coefs.data(), inits.data(), N);
+    multi_core_filter(data.begin(), data.end(), result.begin());
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));    
+
+};
+
+TEST_CASE("runtime series against compile-time series:"){
+
+    T coefs[3][5] = {1,b1,b2,a1,a2,1,-b1,b2,a1,-a2,1,b2,b1,-a1,a2}; 
+    T inits[3][4] = {xi1,xi2,yi1,yi2,xi2,xi1,yi2,yi1,0,0,0,0};
+
+    auto S = series_from_coeffs<T,V>(coefs, inits);
+    RuntimeSeries<V> R(&coefs[0][0], &inits[0][0], 3);
+
+    std::array<T,L> data;
+    std::iota(data.begin(), data.end(), 0);
+
+    for (int n = 0; n < M; n++){
+        V x, y, r;
+        x.load(&data[n*M]);
+        y = S.series_option1(x);
+        r = R.series_option1(x);
+        for (int m = 0; m < M; m++) CHECK(r[m] == doctest::Approx(y[m]));
+    }
+
+    for (int n = 0; n < M; n++) 
+        CHECK(R.series_scalar(data[n]) == doctest::Approx(S.series_scalar(data[n])));
+
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,147 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <sstream>
+#include <cmath>
+#include <cstring>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("seekable stream:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3, 1,2,1,-0.6,-0.2, 1,-0.3,0,0.7,0};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0.6,2,1.5};
+
+TEST_CASE("random reads against the whole filtered recording:"){
+
+    constexpr size_t len = 50*L+21, K = 4*L;
+
+    auto data = test_signal<T>(len);
+
+    std::vector<T> ex_result(len);
+    MultiCoreFilter<T> filter(coefs, inits);
+    filter(data.begin(), data.end(), ex_result.begin());
+
+    SeekableFilter<T> seek(coefs, inits, K);
+
+    std::vector<T> built(len);
+    seek.build(data.data(), len, built.data());
+
+    CHECK(seek.checkpoints() == int(len/K) + 1);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(built[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+
+    // reads at checkpoints, within their distance, across several of them and after the last one
+    const size_t ranges[][2] = {{0, 10}, {K, K+L}, {3*K+5, 3*K+5}, {7*K-1, 9*K+33}, {len/K*K+3, len}, {17, len}};
+
+    for (auto& r: ranges){
+
+        std::vector<T> out(r[1] - r[0]);
+        seek(data.data(), r[0], r[1], out.data());
+
+        for (size_t n = r[0]; n < r[1]; n++)
+            CHECK(out[n - r[0]] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+    }
+};
+
+TEST_CASE("checkpoints through a side file:"){
+
+    constexpr size_t len = 20*L+7, K = 3*L+1;
+
+    auto data = test_signal<T>(len);
+
+    SeekableFilter<T> seek(coefs, inits, K);
+    seek.build(data.data(), len);
+
+    std::stringstream file;
+    REQUIRE(seek.save(file));
+
+    SeekableFilter<T> loaded;
+    REQUIRE(loaded.load(file));
+
+    CHECK(loaded.distance() == K);
+    REQUIRE(loaded.checkpoints() == seek.checkpoints());
+
+    for (int c = 0; c < seek.checkpoints(); c++)
+        for (int j = 0; j < 4*N; j++)
+            CHECK(loaded.checkpoint(c)[j] == seek.checkpoint(c)[j]);
+
+    std::vector<T> r_seek(L), r_loaded(L);
+    seek(data.data(), 11*L, 12*L, r_seek.data());
+    loaded(data.data(), 11*L, 12*L, r_loaded.data());
+    CHECK(r_seek == r_loaded);
+
+    // not a side file
+    std::stringstream bad("not a side file of checkpoints");
+    CHECK(!loaded.load(bad));
+    CHECK(loaded.checkpoints() == seek.checkpoints());
+
+    // a header of more checkpoints than the file holds, and a truncated file
+    std::string bytes = file.str();
+    uint32_t many = 0xffffffff;
+    std::memcpy(&bytes[12], &many, sizeof(many));
+
+    std::stringstream huge(bytes), cut(file.str().substr(0, file.str().size() - 1));
+    CHECK(!loaded.load(huge));
+    CHECK(!loaded.load(cut));
+    CHECK(loaded.checkpoints() == seek.checkpoints());
+};
+
+TEST_CASE("incremental re-filtering after an edit:"){
+
+    constexpr size_t len = 400*L+3, K = 16*L, a = 37*L+5, b = 40*L+2;
+
+    auto data = test_signal<T>(len);
+
+    SeekableFilter<T> seek(coefs, inits, K);
+
+    std::vector<T> out(len);
+    seek.build(data.data(), len, out.data());
+
+    // repair a region, the old values are kept for the edit
+    std::vector<T> old(data.begin() + a, data.begin() + b);
+    for (size_t n = a; n < b; n++) data[n] = 0.5*std::cos(0.2*n);
+
+    size_t end = seek.edit(data.data(), len, a, b, old.data(), out.data(), 1e-6);
+
+    // the correction has decayed long before the end of the recording
+    CHECK(end > b);
+    CHECK(end < len/2);
+
+    SeekableFilter<T> rebuilt(coefs, inits, K);
+    std::vector<T> ex_result(len);
+    rebuilt.build(data.data(), len, ex_result.data());
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(out[n] == doctest::Approx(ex_result[n]).epsilon(1e-3).scale(1e-2));
+
+    for (int c = 0; c < seek.checkpoints(); c++)
+        for (int j = 0; j < 4*N; j++)
+            CHECK(seek.checkpoint(c)[j] == doctest::Approx(rebuilt.checkpoint(c)[j]).epsilon(1e-3).scale(1e-2));
+
+    // reads after the edit start from the patched checkpoints
+    std::vector<T> r(2*L);
+    seek(data.data(), b + 5*L, b + 7*L, r.data());
+    for (size_t n = 0; n < r.size(); n++)
+        CHECK(r[n] == doctest::Approx(ex_result[b + 5*L + n]).epsilon(1e-3).scale(1e-2));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
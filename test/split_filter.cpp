@@ -0,0 +1,88 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("numerator and denominator split:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+TEST_CASE("combined numerator:"){
+
+    T coefs[2][5] = {2,1,0.5,0.3,0.1, 0.5,-1,0.25,0.2,-0.4};
+
+    auto B = cascade_numerator(&coefs[0][0], 2, T(3));
+
+    // 3*(2 + z + 0.5z^2)*(0.5 - z + 0.25z^2)
+    REQUIRE(B.size() == 5);
+    CHECK(B[0] == doctest::Approx(3*1.0));
+    CHECK(B[1] == doctest::Approx(3*(-2 + 0.5)));
+    CHECK(B[2] == doctest::Approx(3*(0.5 - 1 + 0.25)));
+    CHECK(B[3] == doctest::Approx(3*(0.25 - 0.5)));
+    CHECK(B[4] == doctest::Approx(3*0.125));
+};
+
+TEST_CASE("split filter with b0 and gain over several calls:"){
+
+    T coefs[N][5] = {2,0.1,-0.5,0.5,-0.3, 0.5,0.4,0.2,-0.6,-0.2, 1.5,-0.3,0.1,0.9,-0.5};
+    const T gain = 0.8;
+
+    // the calls between split2 and split3 are shorter than the numerator reaches back
+    constexpr size_t len = 19*L+11, split1 = 3*L+5, split2 = 12*L, split3 = 12*L+8;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, nullptr, true);
+    for (auto& v: ex_result) v *= gain;
+
+    SplitFilter<T> filter(coefs, gain);
+
+    std::vector<T> result(len);
+    filter(data.data(), result.data(), split1);
+    filter(data.data() + split1, result.data() + split1, split2 - split1);
+    for (size_t n = split2; n < split3; n += 2)
+        filter(data.data() + n, result.data() + n, 2);
+    filter(data.data() + split3, result.data() + split3, len - split3);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_CASE("split filter agrees with the sections for b0 = 1:"){
+
+    T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3, 1,0.4,0.2,-0.6,-0.2, 1,-0.3,0.1,0.9,-0.5};
+    T inits[N][4] = {0};
+
+    constexpr size_t len = 9*L+3;
+
+    auto data = test_signal<T>(len);
+
+    std::vector<T> r_split(len), r_sos(len);
+
+    SplitFilter<T> split(coefs);
+    split(data.data(), r_split.data(), len);
+
+    MultiCoreFilter<T> sos(coefs, inits);
+    sos(data.begin(), data.end(), r_sos.begin());
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(r_split[n] == doctest::Approx(r_sos[n]).epsilon(1e-3));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
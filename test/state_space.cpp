@@ -0,0 +1,154 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("state space realization:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 4;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,-0.3, 1,0.4,0.2,-0.6,-0.2, 1,-0.3,0.1,0.9,-0.5, 1,0.2,0.3,-0.1,0.4};
+
+// the inputs before a section are the outputs before the previous one
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.4,0.2,-1,0.6, -1,0.6,2,1.5, 2,1.5,-0.3,0.7};
+
+TEST_CASE("state space cores:"){
+
+    constexpr size_t len = 6*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    StateSpaceCore<V> sc(&coefs[0][0], N, &inits[0][0]), v1(&coefs[0][0], N, &inits[0][0]), v3(&coefs[0][0], N, &inits[0][0]);
+
+    std::vector<T> r_sc(len), r_v1(len), r_v3(len);
+
+    for (size_t n = 0; n < len; n++) r_sc[n] = sc.benchmark(data[n]);
+
+    for (size_t n = 0; n < len; n += M){
+        V x;
+        x.load(&data[n]);
+        v1.option1(x).store(&r_v1[n]);
+    }
+
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y = v3.option3(x);
+        for (auto j = 0; j < M; j++) y[j].store(&r_v3[n + j*M]);
+    }
+
+    for (size_t n = 0; n < len; n++){
+        CHECK(r_sc[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v1[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+        CHECK(r_v3[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+    }
+
+    T post_sc[4*N], post_v3[4*N];
+    sc.get_inits(post_sc);
+    v3.get_inits(post_v3);
+
+    CHECK(post_v3[0] == data[len-1]);
+    CHECK(post_v3[1] == data[len-2]);
+    for (int i = 0; i < 4*N; i++)
+        CHECK(post_v3[i] == doctest::Approx(post_sc[i]).epsilon(1e-3));
+};
+
+TEST_CASE("state space filter over several calls:"){
+
+    constexpr size_t len = 23*L+13, split1 = 5*L+3, split2 = 17*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    StateSpaceFilter<T> filter(coefs, inits);
+
+    CHECK(filter.state_size() == 2*N+2);
+
+    std::vector<T> result(len);
+    filter(data.data(), result.data(), split1);
+    filter(data.data() + split1, result.data() + split1, split2 - split1);
+    filter(data.data() + split2, result.data() + split2, len - split2);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+
+    T post[4*N];
+    filter.get_inits(post);
+    CHECK(post[0] == data[len-1]);
+    CHECK(post[4*N-2] == doctest::Approx(ex_result[len-1]).epsilon(1e-3));
+};
+
+TEST_CASE("state space filter over groups of tiles:"){
+
+    // more tiles than groups on any machine, so the groups carry their state over several tiles and the last one is short
+    constexpr size_t len = 1000*L+5*M+3;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    StateSpaceFilter<T> filter(coefs, inits);
+
+    std::vector<T> result(len);
+    filter(data.data(), result.data(), len);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+};
+
+TEST_CASE("circular filtering against repeated periods:"){
+
+    for (size_t len: {size_t(5*L), size_t(5*L+3*M+5), size_t(L+1), size_t(3*M+2), size_t(7)}){
+
+        auto data = test_signal<T>(len);
+
+        // the periodic steady state by filtering the period many times in double precision
+        std::vector<double> s(4*N, 0.0), y(len);
+        for (int k = 0; k < 40 + int(4000/len); k++)
+            for (size_t n = 0; n < len; n++){
+
+                double x = data[n];
+                for (int i = 0; i < N; i++){
+                    double* r = &s[4*i];
+                    double v = x + coefs[i][1]*r[0] + coefs[i][2]*r[1] + coefs[i][3]*r[2] + coefs[i][4]*r[3];
+                    r[1] = r[0]; r[0] = x; r[3] = r[2]; r[2] = v;
+                    x = v;
+                }
+                y[n] = x;
+            }
+
+        StateSpaceFilter<T> filter(coefs, inits);
+
+        std::vector<T> result(len);
+        filter.circular(data.data(), result.data(), len);
+
+        for (size_t n = 0; n < len; n++)
+            CHECK(result[n] == doctest::Approx(y[n]).epsilon(1e-3));
+
+        // the state of the stream is not used
+        T post[4*N];
+        filter.get_inits(post);
+        CHECK(post[2] == inits[0][2]);
+    }
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,86 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("steady state:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 2;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2};
+
+TEST_CASE("steady state of a constant input:"){
+
+    constexpr size_t len = 10*L+3;
+    const T u = 1.5;
+
+    T zi[N][4];
+    steady_inits(coefs, u, zi);
+
+    // the output level of the cascade is the product of the DC gains
+    T g = 1;
+    for (int i=0;i<N;i++) g *= (1 + coefs[i][1] + coefs[i][2])/(1 - coefs[i][3] - coefs[i][4]);
+
+    std::vector<T> data(len, u), result(len);
+
+    auto multi_core_filter = makeMultiCoreFilter(coefs,zi);
+    multi_core_filter(data.begin(), data.end(), result.begin());
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(g*u).epsilon(1e-4));
+
+    // an integrator has no steady state, it and the sections after it start from rest
+    T integ[2][5] = {1,0,0,1,0, 1,0.5,0,0.2,0};
+    T zj[2][4];
+    steady_inits(integ, u, zj);
+
+    for (int j=0;j<4;j++){
+        CHECK(zj[0][j] == 0);
+        CHECK(zj[1][j] == 0);
+    }
+
+};
+
+TEST_CASE("a pole at DC within the rounding of the coefficients:"){
+
+    const T u = 1.5;
+
+    // poles at 1 and 0.8, the sum of a1 and a2 in float misses 1 by one ulp
+    T near[2][5] = {1,0,0,1.8,-0.8, 1,0.5,0,0.2,0};
+    CHECK(near[0][3] + near[0][4] != T(1));
+
+    T zi[2][4];
+    steady_inits(near, u, zi);
+
+    for (int j=0;j<4;j++){
+        CHECK(zi[0][j] == 0);
+        CHECK(zi[1][j] == 0);
+    }
+
+    // a slow pole close to DC still has its steady state
+    T slow[1][5] = {1,0,0,1.8,-0.81};
+    T zs[1][4];
+    steady_inits(slow, u, zs);
+
+    CHECK(zs[0][0] == u);
+    CHECK(zs[0][2] == doctest::Approx(u/(1 - 1.8 + 0.81)).epsilon(1e-4));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,142 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+#include <atomic>
+#include <thread>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("stream scheduler:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+TEST_CASE("streams of different coefficients, section counts and packets:"){
+
+    constexpr int S = 41;
+
+    // packets per stream and run
+    constexpr int P = 3;
+
+    StreamScheduler<T> scheduler(2);
+
+    std::vector<std::vector<T>> coefs(S), inits(S), data(S), result(S);
+    std::vector<std::vector<double>> ex_result(S);
+    std::vector<int> id(S);
+
+    for (int s = 0; s < S; s++){
+
+        // 1 or 2 sections, each stream with its own coefficients
+        int n = 1 + s%2;
+        for (int i = 0; i < n; i++){
+            coefs[s].insert(coefs[s].end(), {1, T(0.1+0.01*s), T(-0.5+0.1*i), T(0.5-0.005*s), T(0.3-0.1*i)});
+            inits[s].insert(inits[s].end(), {T(0.1*s), 1, T(-0.2), T(0.01*s)});
+        }
+
+        id[s] = scheduler.add_stream(coefs[s].data(), inits[s].data(), n);
+
+        size_t len = (s*37) % 301;
+        data[s] = test_signal<T>(len, 0.05, s);
+        result[s].resize(len);
+
+        // reference: one filter per stream
+        ex_result[s] = reference(data[s], coefs[s].data(), n, inits[s].data());
+    }
+
+    // packets arrive in two rounds, the second run continues from the state of the first one
+    for (int round = 0; round < 2; round++){
+
+        for (int p = 0; p < P; p++)
+            for (int s = S-1; s >= 0; s--){
+
+                size_t len = data[s].size();
+                size_t lo = round ? len/2 : 0, hi = round ? len : len/2;
+                size_t first = lo + (hi-lo)*p/P, last = lo + (hi-lo)*(p+1)/P;
+
+                scheduler.push(id[s], data[s].data() + first, result[s].data() + first, last - first);
+            }
+
+        scheduler.run();
+        CHECK(scheduler.pending() == 0);
+    }
+
+    for (int s = 0; s < S; s++){
+
+        for (size_t k = 0; k < data[s].size(); k++)
+            CHECK(result[s][k] == doctest::Approx(ex_result[s][k]).epsilon(1e-4));
+
+        if (data[s].empty()) continue;
+
+        std::vector<T> post(inits[s].size());
+        scheduler.get_inits(id[s], post.data());
+        CHECK(post[post.size()-2] == doctest::Approx(ex_result[s].back()).epsilon(1e-4));
+    }
+};
+
+TEST_CASE("streams that connect and send packets while runs are filtering:"){
+
+    constexpr int S = 64, P = 8;
+    constexpr size_t len = 160;
+
+    StreamScheduler<T> scheduler(2);
+
+    const T coefs[5] = {1, 0.2, -0.3, 0.6, -0.2};
+    std::vector<std::vector<T>> data(S), result(S, std::vector<T>(len));
+    std::vector<std::vector<double>> ex_result(S);
+
+    for (int s = 0; s < S; s++){
+
+        data[s] = test_signal<T>(len, 0.05, s);
+        ex_result[s] = reference(data[s], coefs, 1);
+    }
+
+    // one thread connects the devices and sends their packets, two threads run the scheduler meanwhile
+    std::atomic<bool> done{false};
+    std::vector<int> id(S);
+
+    std::thread device([&]{
+
+        for (int s = 0; s < S; s++){
+
+            id[s] = scheduler.add_stream(coefs, nullptr, 1);
+
+            for (int p = 0; p < P; p++)
+                scheduler.push(id[s], data[s].data() + len*p/P, result[s].data() + len*p/P, len/P);
+        }
+
+        done = true;
+    });
+
+    std::thread run1([&]{ while (!done) scheduler.run(); }), run2([&]{ while (!done) scheduler.run(); });
+
+    device.join();
+    run1.join();
+    run2.join();
+
+    scheduler.run();
+
+    CHECK(scheduler.streams() == S);
+    CHECK(scheduler.pending() == 0);
+
+    for (int s = 0; s < S; s++){
+
+        for (size_t k = 0; k < len; k++)
+            CHECK(result[s][k] == doctest::Approx(ex_result[s][k]).epsilon(1e-4));
+
+        T post[4];
+        scheduler.get_inits(id[s], post);
+        CHECK(post[2] == doctest::Approx(ex_result[s].back()).epsilon(1e-4));
+    }
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
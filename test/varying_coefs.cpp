@@ -0,0 +1,182 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <memory>
+#include <iterator>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("time-varying coefficients:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+const T xi1 = 1, xi2 = 4, yi1 = -0.2, yi2 = 2.5;
+
+constexpr int N = 2;
+constexpr size_t len = 40*L+5;
+
+T coefs[N][5] = {1,0.1,-0.5,0.5,0.3,1,0.2,0.1,-0.4,0.2}; 
+T coefs2[N][5] = {1,0.4,0.1,-0.6,0.2,1,-0.3,0.2,0.6,-0.3}; 
+T inits[N][4] = {xi1,xi2,yi1,yi2,xi2,xi1,yi2,yi1};
+
+// the control point is reached by the block containing sample at
+const size_t at = 12*L+9, kb = at/L;
+
+// filter sample by sample, the coefficients of block k of each section are given by coef(i, k, c)
+template<typename F> std::vector<T> varying_reference(const std::vector<T>& data, F coef){
+
+    IirCoreOrderTwo<V> IIR1(coefs[0], inits[0]), IIR2(coefs[1], inits[1]);
+    std::vector<T> ex_result(len);
+    std::array<T,4> c[N];
+
+    for (size_t n = 0; n < len; n++){
+        if (n % L == 0){
+            c[0] = coef(0, n/L, c[0]);
+            c[1] = coef(1, n/L, c[1]);
+            IIR1.table_refresh(make_section_table<V>(c[0][0], c[0][1], c[0][2], c[0][3]));
+            IIR2.table_refresh(make_section_table<V>(c[1][0], c[1][1], c[1][2], c[1][3]));
+        }
+        ex_result[n] = IIR2.benchmark(IIR1.benchmark(data[n]));
+    }
+
+    return ex_result;
+}
+
+// the stream arrives in chunks of different lengths
+std::vector<T> run(VaryingFilter<T>& filter, const std::vector<T>& data){
+
+    std::vector<T> result(len);
+
+    auto first = data.begin();
+    auto d_first = result.begin();
+    for (size_t chunk: std::vector<size_t>{3*L+1, 10*L+7, M-1, 2*L-5, 20*L, len}){
+        auto last = first + std::min<size_t>(chunk, std::distance(first, data.end()));
+        d_first = filter(first, last, d_first);
+        first = last;
+    }
+
+    return result;
+}
+
+TEST_CASE("linear interpolation between control points:"){
+
+    auto data = test_signal<T>(len);
+
+    auto ex_result = varying_reference(data, [](int i, size_t k, std::array<T,4>){
+        std::array<T,4> c;
+        T w = (k < kb) ? T(k)/T(kb) : T(1);
+        for (auto q=0; q<4; q++) c[q] = coefs[i][q+1] + w*(coefs2[i][q+1] - coefs[i][q+1]);
+        return c;
+    });
+
+    VaryingFilter<T> filter(coefs, inits, Interp::linear);
+    filter.control(coefs2, at);
+
+    auto result = run(filter, data);
+
+    CHECK(filter.position() == len);
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));    
+
+};
+
+TEST_CASE("exponential move between control points:"){
+
+    auto data = test_signal<T>(len, 0.03);
+
+    const T tau = 3, alpha = std::exp(T(-1)/tau);
+
+    auto ex_result = varying_reference(data, [alpha](int i, size_t k, std::array<T,4>){
+        std::array<T,4> c;
+        T w = (k < kb) ? (1 - std::pow(alpha, T(k)))/(1 - std::pow(alpha, T(kb))) : T(1);
+        for (auto q=0; q<4; q++) c[q] = coefs[i][q+1] + w*(coefs2[i][q+1] - coefs[i][q+1]);
+        return c;
+    });
+
+    VaryingFilter<T> filter(coefs, inits, Interp::exponential, tau);
+    filter.control(coefs2, at);
+
+    auto result = run(filter, data);
+
+    for (size_t n = 0; n < len; n++) 
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));    
+
+};
+
+TEST_CASE("a control point added after a hold ramps from the held coefficients:"){
+
+    CoefControl<T> ctrl(coefs[0]);
+    ctrl.point(100, coefs2[0]);
+
+    std::array<T,4> c;
+    for (size_t k = 0; k < 150; k++) c = ctrl.next();
+
+    // the last block held at coefs2, the new point is 51 blocks ahead of it.
+    ctrl.point(200, coefs[1]);
+
+    for (size_t k = 150; k <= 200; k++){
+
+        auto d = ctrl.next();
+        for (auto q=0; q<4; q++){
+            T step = std::abs(coefs[1][q+1] - coefs2[0][q+1])/51;
+            CHECK(std::abs(d[q] - c[q]) <= doctest::Approx(step).epsilon(1e-4));
+        }
+        c = d;
+    }
+
+    for (auto q=0; q<4; q++) CHECK(c[q] == doctest::Approx(coefs[1][q+1]));
+
+};
+
+TEST_CASE("a control point added mid-ramp ramps from the current coefficients:"){
+
+    CoefControl<T> ctrl(coefs[0]);
+    ctrl.point(100, coefs2[0]);
+
+    std::array<T,4> c;
+    for (size_t k = 0; k < 50; k++) c = ctrl.next();
+
+    // the new point goes ahead of the pending one, 11 blocks after the last block.
+    ctrl.point(60, coefs[1]);
+
+    for (size_t k = 50; k <= 60; k++){
+
+        auto d = ctrl.next();
+        for (auto q=0; q<4; q++){
+            T step = std::abs(coefs[1][q+1] - c[q])/T(61 - k);
+            CHECK(std::abs(d[q] - c[q]) <= doctest::Approx(step).epsilon(1e-4));
+        }
+        c = d;
+    }
+
+    for (auto q=0; q<4; q++) CHECK(c[q] == doctest::Approx(coefs[1][q+1]));
+
+    // then on to the pending point.
+    for (size_t k = 61; k <= 100; k++){
+
+        auto d = ctrl.next();
+        for (auto q=0; q<4; q++){
+            T step = std::abs(coefs2[0][q+1] - coefs[1][q+1])/40;
+            CHECK(std::abs(d[q] - c[q]) <= doctest::Approx(step).epsilon(1e-4));
+        }
+        c = d;
+    }
+
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
@@ -0,0 +1,95 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("truncated warm-up:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+// poles of radius 0.9 (complex), 0.8 and 0.5 (real), and 0.7 and 0.5 (real)
+T coefs[N][5] = {1,0.1,-0.5,1.2,-0.81, 1,2,1,1.3,-0.4, 1,-0.3,0.1,0.2,0.35};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0.6,2,1.5};
+
+TEST_CASE("pole radius and warm-up length:"){
+
+    CHECK(pole_radius(coefs[0], 1) == doctest::Approx(0.9));
+    CHECK(pole_radius(coefs[1], 1) == doctest::Approx(0.8));
+    CHECK(pole_radius(coefs[2], 1) == doctest::Approx(0.7));
+    CHECK(pole_radius(&coefs[0][0], N) == doctest::Approx(0.9));
+
+    // without poles the state is the inputs of each section
+    T fir[2][5] = {1,0.5,0.2,0,0, 1,-1,0.3,0,0};
+    CHECK(warmup_length(&fir[0][0], 2, 1e-6) == 4);
+
+    size_t W4 = warmup_length(&coefs[0][0], N, 1e-4), W6 = warmup_length(&coefs[0][0], N, 1e-6);
+    CHECK(W4 < W6);
+};
+
+TEST_CASE("chunks with warm-up over several calls:"){
+
+    constexpr size_t len = 40*L+17, split = 13*L+5;
+    const double tol = 1e-4;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    // small chunks, so that most of them start from the warm-up
+    WarmupFilter<T> filter(coefs, inits, tol, 2*L);
+    REQUIRE(filter.chunk() == 2*L);
+
+    std::vector<T> result(len);
+    filter(data.data(), result.data(), split);
+    filter(data.data() + split, result.data() + split, len - split);
+
+    // the largest possible output, the largest input times the L1 norm of the impulse response
+    std::vector<T> impulse(4*filter.overlap(), T(0));
+    impulse[0] = 1;
+    double norm = 0;
+    for (auto v: reference(impulse, &coefs[0][0], N)) norm += std::abs(v);
+
+    double peak = 0;
+    for (auto v: data) peak = std::max(peak, std::abs(double(v)));
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(std::abs(result[n] - ex_result[n]) <= tol*peak*norm + 1e-5*std::abs(ex_result[n]));
+};
+
+TEST_CASE("chunks shorter than the warm-up:"){
+
+    constexpr size_t len = 16*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, &coefs[0][0], N);
+
+    WarmupFilter<T> filter(coefs, 1e-6, L);
+
+    std::vector<T> result(len);
+    filter(data.data(), result.data(), len);
+
+    // the warm-up of a chunk spans several chunks before it
+    double err = 0;
+    for (size_t n = 0; n < len; n++) err = std::max(err, std::abs(result[n] - ex_result[n]));
+
+    CHECK(err < 1e-3);
+    CHECK(filter.overlap() > size_t(L));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
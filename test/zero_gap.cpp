@@ -0,0 +1,138 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <chrono>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("jump over zero-input gaps:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+constexpr int N = 3;
+
+// the inits of inputs of the sections are not the outputs of the sections before
+T coefs[N][5] = {1,0.1,-0.5,1.2,-0.81, 1,2,1,1.3,-0.4, 1,-0.3,0,0.6,0};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0.6,2,1.5};
+
+TEST_CASE("jump of the initial conditions against the recursive equations:"){
+
+    for (size_t K: {0, 1, 2, 3, 7, 100, 1001}){
+
+        double s[N][4];
+        for (int i = 0; i < N; i++) for (int j = 0; j < 4; j++) s[i][j] = inits[i][j];
+
+        for (size_t k = 0; k < K; k++){
+
+            double x = 0;
+            for (int i = 0; i < N; i++){
+                double y = x + coefs[i][1]*s[i][0] + coefs[i][2]*s[i][1] + coefs[i][3]*s[i][2] + coefs[i][4]*s[i][3];
+                s[i][1] = s[i][0]; s[i][0] = x; s[i][3] = s[i][2]; s[i][2] = y;
+                x = y;
+            }
+        }
+
+        T jump[N][4];
+        std::copy(&inits[0][0], &inits[0][0] + 4*N, &jump[0][0]);
+        advance_zero(coefs, jump, K);
+
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < 4; j++)
+                CHECK(jump[i][j] == doctest::Approx(s[i][j]).epsilon(1e-4).scale(1e-3));
+    }
+};
+
+TEST_CASE("a stream with gaps against zeros through the filter:"){
+
+    constexpr size_t len = 6*L+5;
+    const size_t gaps[] = {3, 2*L+1, 977};
+
+    auto data = test_signal<T>(len);
+
+    MultiCoreFilter<T> zeros(coefs, inits), jump(coefs, inits);
+
+    // a swap of coefficients within the last gap
+    T coefs2[N][5] = {1,0.4,0.1,0.5,-0.3, 1,2,1,1.3,-0.4, 1,-0.3,0.2,0.1,0.2};
+    const size_t at = 3*len + gaps[0] + gaps[1] + 500;
+    zeros.swap_coefs(coefs2, at);
+    jump.swap_coefs(coefs2, at);
+
+    std::vector<T> r_zeros(len), r_jump(len);
+
+    for (auto K: gaps){
+
+        zeros(data.begin(), data.end(), r_zeros.begin());
+        jump(data.begin(), data.end(), r_jump.begin());
+
+        std::vector<T> z(K, T(0)), y(K);
+        zeros(z.begin(), z.end(), y.begin());
+        jump.advance_zero(K);
+
+        CHECK(jump.position() == zeros.position());
+
+        for (size_t n = 0; n < len; n++)
+            CHECK(r_jump[n] == doctest::Approx(r_zeros[n]).epsilon(1e-3));
+    }
+
+    zeros(data.begin(), data.end(), r_zeros.begin());
+    jump(data.begin(), data.end(), r_jump.begin());
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(r_jump[n] == doctest::Approx(r_zeros[n]).epsilon(1e-3));
+};
+
+TEST_CASE("the cost does not grow with the gap:"){
+
+    MultiCoreFilter<T> filter(coefs, inits);
+
+    auto start = std::chrono::steady_clock::now();
+    filter.advance_zero(size_t(1) << 40);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(elapsed < 0.1);
+    CHECK(filter.position() == (size_t(1) << 40));
+
+    // the state of a stable cascade has decayed
+    std::vector<T> x(M, T(0)), y(M);
+    filter(x.begin(), x.end(), y.begin());
+    for (auto v: y) CHECK(std::abs(v) < 1e-6);
+};
+
+TEST_CASE("bound of the response to a state:"){
+
+    // the response from the inits stays below the bound
+    double G = state_gain(&coefs[0][0], N), m = 0, s[N][4];
+    for (int i = 0; i < N; i++) for (int j = 0; j < 4; j++) m = std::max(m, std::abs(double(s[i][j] = inits[i][j])));
+
+    for (size_t k = 0; k < 2000; k++){
+
+        double x = 0;
+        for (int i = 0; i < N; i++){
+            double y = x + coefs[i][1]*s[i][0] + coefs[i][2]*s[i][1] + coefs[i][3]*s[i][2] + coefs[i][4]*s[i][3];
+            s[i][1] = s[i][0]; s[i][0] = x; s[i][3] = s[i][2]; s[i][2] = y;
+            x = y;
+        }
+
+        CHECK(std::abs(x) <= G*m);
+    }
+
+    // without poles the responses end after two samples: 0.5 from xi1 and 0.2 from xi2
+    const T fir[5] = {1, 0.5, 0.2, 0, 0};
+    CHECK(state_gain(fir, 1) == doctest::Approx(0.7));
+};
+
+TEST_SUITE_END();
+
+#endif // doctest
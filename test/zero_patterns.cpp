@@ -0,0 +1,145 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include <tbb/tbb.h>
+#include "recursive_filter.h"
+#include "fixtures.h"
+#include <numeric>
+#include <cmath>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+
+#define TBB_DEPRECATED_LIMITER_NODE_CONSTRUCTOR 1
+#define TBB_PREVIEW_FLOW_GRAPH_NODES 1
+
+TEST_SUITE_BEGIN("patterns of zeros:");
+
+using V = Vec8f;
+using T = decltype(std::declval<V>().extract(0));
+
+constexpr int M = V::size();
+constexpr int L = M*M;
+
+// all-pole, lowpass, highpass, bandpass and general numerators
+constexpr int N = 5;
+
+T coefs[N][5] = {1,0,0,0.5,-0.3, 1,2,1,-0.6,-0.2, 1,-2,1,0.9,-0.5, 1,0,-1,-0.1,0.4, 1,0.3,-0.4,0.2,-0.7};
+T inits[N][4] = {1,-0.5,0.4,0.2, 0.3,0.2,-1,0.6, -1,0.6,2,1.5, 2,1.5,-0.3,0.7, 0.1,-0.2,0.3,0.4};
+
+template<Zeros Z> void check_core(const int i){
+
+    constexpr size_t len = 5*L;
+
+    auto data = test_signal<T>(len);
+    auto ex_result = reference(data, coefs[i], 1, inits[i]);
+
+    IirCoreOrderTwo<V,Z> sc(coefs[i], inits[i]), v1(coefs[i], inits[i]), v2(coefs[i], inits[i]), v3(coefs[i], inits[i]);
+
+    std::vector<T> r_sc(len), r_v1(len), r_v2(len), r_v3(len);
+
+    for (size_t n = 0; n < len; n++) r_sc[n] = sc.benchmark(data[n]);
+
+    for (size_t n = 0; n < len; n += M){
+        V x;
+        x.load(&data[n]);
+        v1.option1(x).store(&r_v1[n]);
+    }
+
+    for (size_t n = 0; n < len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y2 = v2.option2(x), y3 = v3.option3(x);
+        for (auto j = 0; j < M; j++){
+            y2[j].store(&r_v2[n + j*M]);
+            y3[j].store(&r_v3[n + j*M]);
+        }
+    }
+
+    for (size_t n = 0; n < len; n++){
+        CHECK(r_sc[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v1[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v2[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+        CHECK(r_v3[n] == doctest::Approx(ex_result[n]).epsilon(1e-4));
+    }
+
+    T post[4];
+    v3.get_inits(post);
+    CHECK(post[0] == data[len-1]);
+    CHECK(post[1] == data[len-2]);
+}
+
+TEST_CASE("detect the pattern of the numerator:"){
+
+    CHECK(zeros_of<T>(0, 0) == Zeros::all_pole);
+    CHECK(zeros_of<T>(2, 1) == Zeros::lowpass);
+    CHECK(zeros_of<T>(-2, 1) == Zeros::highpass);
+    CHECK(zeros_of<T>(0, -1) == Zeros::bandpass);
+    CHECK(zeros_of<T>(0.3, -0.4) == Zeros::general);
+
+    CHECK(make_section_table<V>(coefs[2])->zeros == Zeros::highpass);
+};
+
+TEST_CASE("kernels of the patterns selected at compile time:"){
+
+    check_core<Zeros::all_pole>(0);
+    check_core<Zeros::lowpass>(1);
+    check_core<Zeros::highpass>(2);
+    check_core<Zeros::bandpass>(3);
+
+    // the full numerator works for every pattern
+    for (int i = 0; i < N; i++) check_core<Zeros::general>(i);
+};
+
+TEST_CASE("kernels of the patterns selected by the tables:"){
+
+    for (int i = 0; i < N; i++) check_core<Zeros::runtime>(i);
+};
+
+TEST_CASE("patterns in series and in the multi-core graph:"){
+
+    constexpr size_t len = 17*L+9, split = 6*L+3;
+
+    auto data = test_signal<T>(len);
+
+    auto ex_result = reference(data, &coefs[0][0], N, &inits[0][0]);
+
+    auto S = make_series(IirCoreOrderTwo<V,Zeros::all_pole>(coefs[0], inits[0]), IirCoreOrderTwo<V,Zeros::lowpass>(coefs[1], inits[1]),
+                         IirCoreOrderTwo<V,Zeros::highpass>(coefs[2], inits[2]), IirCoreOrderTwo<V,Zeros::bandpass>(coefs[3], inits[3]),
+                         IirCoreOrderTwo<V>(coefs[4], inits[4]));
+
+    std::vector<T> r_series(len);
+    for (size_t n = 0; n + L <= len; n += L){
+
+        std::array<V,M> x;
+        for (auto j = 0; j < M; j++) x[j].load(&data[n + j*M]);
+
+        auto y = _permuteV(S.series_option3(_permuteV(x)));
+        for (auto j = 0; j < M; j++) y[j].store(&r_series[n + j*M]);
+    }
+
+    for (size_t n = 0; n + L <= len; n++)
+        CHECK(r_series[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+
+    // the all-pole section goes without the initial conditions of inputs, which are still kept in its state
+    std::vector<T> result(len);
+
+    MultiCoreFilter<T> filter(coefs, inits);
+    filter(data.begin(), data.begin() + split, result.begin());
+    filter(data.begin() + split, data.end(), result.begin() + split);
+
+    for (size_t n = 0; n < len; n++)
+        CHECK(result[n] == doctest::Approx(ex_result[n]).epsilon(1e-3));
+
+    TBBIIRMultiCore<V> mc(coefs, inits);
+    auto out = mc(std::vector<T>(data.begin(), data.begin() + 4*L));
+
+    REQUIRE(out.second.size() == 4*N);
+    CHECK(out.second[0] == data[4*L-2]);
+    CHECK(out.second[1] == data[4*L-1]);
+};
+
+TEST_SUITE_END();
+
+#endif // doctest